@@ -0,0 +1,274 @@
+/**
+ * \brief Benchmarks.
+ * \file bench.cc Microbenchmarks of the solver, field and I/O hot paths
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <log.h>
+#include <grid.h>
+#include <strip.h>
+#include <slot.h>
+#include <sweep.h>
+#include <batch.h>
+
+using namespace std;
+using namespace eim;
+
+/**
+ * \brief keep the compiler from discarding a result
+ */
+template<typename T>
+inline void
+keep(T const& x)
+{
+	asm volatile("" : : "g"(&x) : "memory");
+}
+
+/**
+ * \brief A benchmark result, one entry of the JSON output
+ */
+struct result
+{
+	string name;      ///< benchmark name
+	size_t size;      ///< problem size, e.g. points per axis or sweep points
+	double ns;        ///< median wall time per call in nanoseconds
+	double rate;      ///< throughput per second
+	const char* unit; ///< unit of the throughput
+};
+
+static vector<result> results;
+
+/**
+ * \brief Time a callable
+ *
+ * The repetitions are doubled until a sample takes at least min_time, then the median of
+ * the samples is recorded.
+ *
+ * \param name benchmark name
+ * \param size problem size
+ * \param work units of work per call, e.g. solves, points or bytes
+ * \param unit unit of the throughput
+ * \param f the callable
+ */
+template<typename F>
+void
+bench(const string& name, size_t size, double work, const char* unit, F&& f)
+{
+	using clock = chrono::steady_clock;
+	constexpr double min_time = 0.05;
+	constexpr int samples = 5;
+
+	f();
+	size_t reps = 1;
+	for (;;)
+	{
+		auto t0 = clock::now();
+		for (size_t r = 0; r < reps; r++)
+			f();
+		double t = chrono::duration<double>(clock::now() - t0).count();
+		if (t >= min_time || reps >= (size_t(1) << 30))
+			break;
+		reps *= 2;
+	}
+
+	vector<double> ns(samples);
+	for (auto& s : ns)
+	{
+		auto t0 = clock::now();
+		for (size_t r = 0; r < reps; r++)
+			f();
+		s = chrono::duration<double, nano>(clock::now() - t0).count() / reps;
+	}
+	sort(ns.begin(), ns.end());
+
+	double median = ns[samples / 2];
+	results.push_back({name, size, median, work * 1e9 / median, unit});
+	fprintf(stderr, "%-28s %10zu %14.1f ns %14.4g %s\n", name.c_str(), size, median, work * 1e9 / median, unit);
+}
+
+int main(int argc, char const *argv[])
+{
+	const double n_box = 1.44, n_core = 3.47, n_clad = 1.44, lambda = 1.55;
+
+	// Slab solves, over a set of thicknesses so that no two consecutive solves are alike
+	{
+		vector<double> W(64);
+		vec::linspace(W.begin(), W.end(), 0.1, 1.0);
+		size_t k = 0;
+
+		bench("solve_slab", 1, 1, "solves/s", [&]()
+		{
+			keep(solve_slab(n_box, n_core, n_clad, lambda, W[k++ % W.size()], 0));
+		});
+
+		bench("solve_slab_modes", 1, 1, "solves/s", [&]()
+		{
+			keep(solve_slab_all_modes(n_box, n_core, n_clad, lambda, W[k++ % W.size()]));
+		});
+
+		bench("solve_slot_slab", 1, 1, "solves/s", [&]()
+		{
+			keep(solve_slot_slab(1.44, 2.85, 1.44, lambda, 0.1, W[k++ % W.size()] / 2, 0));
+		});
+	}
+
+	// 1D mode profiles
+	for (size_t N : {1000, 100000})
+	{
+		cvector<double> x(N);
+		vec::linspace(x.begin(), x.end(), -1.0, 1.0);
+		cvector<field_t> A(N), Bl(N), Bn(N);
+		double neff = solve_slab_mode<TE>(n_box, n_core, n_clad, lambda, 0.22, 0);
+
+		bench("mode_1D", N, N, "points/s", [&]()
+		{
+			mode_1D<TE>(x.begin(), x.end(), A.begin(), Bl.begin(), Bn.begin(), neff, n_box, n_core, n_clad, lambda, 0.22, 0);
+			keep(A[0]);
+		});
+
+		bench("mode_1D transverse", N, N, "points/s", [&]()
+		{
+			mode_1D<TE, TRANSVERSE_FIELD>(x.begin(), x.end(), A.begin(), nullptr, nullptr, neff, n_box, n_core, n_clad, lambda, 0.22, 0);
+			keep(A[0]);
+		});
+	}
+
+	// Dense outer products and the field writers
+	for (size_t N : {256, 2000})
+	{
+		vector<field_t> a(N), b(N);
+		for (size_t i = 0; i < N; i++)
+		{
+			a[i] = field_t(cos(0.01 * i), sin(0.02 * i));
+			b[i] = field_t(1.0 / (i + 1), 0.5);
+		}
+		cmatrix<field_t> m(N, N);
+		vector<field_t> c(N * N);
+		double bytes = double(N) * N * sizeof(field_t);
+
+		#if PARALLEL
+		bench("async_outer_product", N, bytes * 1e-9, "GB/s", [&]()
+		{
+			vec::async_outer_product<field_t>(a.begin(), a.end(), b.begin(), b.end(), &m[0]);
+			keep(m[0][0]);
+		});
+		#endif
+
+		bench("outer_product", N, bytes * 1e-9, "GB/s", [&]()
+		{
+			vec::outer_product<field_t>(a.begin(), a.end(), b.begin(), b.end(), c.data(), N);
+			keep(c[0]);
+		});
+	}
+
+	// Writers, to the temporary directory
+	{
+		const size_t N = 1000;
+		auto path = (filesystem::temp_directory_path() / "eim_bench.tmp").string();
+
+		Strip wg{lambda, 0.22, 0, 0.5, 0, n_box, n_core, n_clad, 0, TE};
+		cvector<double> x(N);
+		vec::linspace(x.begin(), x.end(), -1.0, 1.0);
+		auto field = wg.mode_field(x);
+
+		grid_header h;
+		h.rows = h.cols = N;
+		double bytes = record_size(h);
+
+		bench("grid_file", N, bytes * 1e-9, "GB/s", [&]()
+		{
+			grid_file out(path, h, 1, x.data(), x.data());
+			field.materialize(out[0].field<field_t>(), N);
+		});
+
+		vector<field_t> row(N);
+		vector<string> xs(N);
+		for (size_t i = 0; i < N; i++)
+			xs[i] = to_string(x[i]);
+
+		bench("csv_writer", N, double(N) * N, "rows/s", [&]()
+		{
+			Log log(path, ",");
+			for (size_t i = 0; i < N; i++)
+			{
+				field.row(i, row.data());
+				for (size_t j = 0; j < N; j++)
+				{
+					log << "0.000000,0.220000,0.500000,TE0" << xs[i] << xs[j] << abs(row[j]);
+					++log;
+				}
+			}
+		});
+
+		filesystem::remove(path);
+	}
+
+	// End to end sweeps over the widths, the vertical stage is cached after the first call
+	for (size_t N : {1000, 100000})
+	{
+		vector<double> L{lambda}, G{0.1}, W(N);
+		vector<unsigned> J{0};
+		vec::linspace(W.begin(), W.end(), 0.1, 1.0);
+		vector<double> neff;
+
+		Strip strip{lambda, 0.22, 0, 0.5, 0, n_box, n_core, n_clad, 0, TE};
+		sweep s{L, {}, W, J};
+		bench("sweep_strip", N, N, "points/s", [&]()
+		{
+			solve_sweep(strip, s, neff);
+			keep(neff[0]);
+		});
+
+		waveguide slot{lambda, 0.22, 0.3, 0.1, n_box, n_clad, n_core, 1.44, 0, TE};
+		sweep t{L, G, W, J};
+		bench("sweep_slot", N, N, "points/s", [&]()
+		{
+			solve_sweep(slot, t, neff);
+			keep(neff[0]);
+		});
+
+		vector<double> neff_odd;
+		bench("sweep_slot both parities", N, N, "points/s", [&]()
+		{
+			solve_sweep(slot, t, neff, &neff_odd);
+			keep(neff_odd[0]);
+		});
+	}
+
+	printf("{\n\t\"parallel\": %d,\n\t\"threads\": %u,\n\t\"results\": [\n", PARALLEL, thread::hardware_concurrency());
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto& r = results[i];
+		printf("\t\t{\"name\": \"%s\", \"size\": %zu, \"ns\": %.6g, \"rate\": %.6g, \"unit\": \"%s\"}%s\n",
+			r.name.c_str(), r.size, r.ns, r.rate, r.unit, (i + 1 < results.size()) ? "," : "");
+	}
+	printf("\t]\n}\n");
+
+	return 0;
+}
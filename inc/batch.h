@@ -0,0 +1,574 @@
+#ifndef __BATCH_H__
+#define __BATCH_H__
+/**
+ * \brief Batched slab solver.
+ * \file batch.h SIMD Batched Slab Mode Equations
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <numeric>
+#include <eim.h>
+#include <strip.h>
+#include <slot.h>
+#include <sweep.h>
+
+namespace eim
+{
+	namespace simd
+	{
+		/**
+		 * \brief Number of slabs solved in lockstep.
+		 * One AVX-512 register, or two AVX2 registers, of double.
+		 */
+		static constexpr size_t lanes = 8;
+
+		/**
+		 * \brief Branch-free arctangent for x >= 0.
+		 *
+		 * The argument is reduced to [0, 0.66] with atan(x) = pi/2 - atan(1/x) above tan(3pi/8)
+		 * and atan(x) = pi/4 + atan((x-1)/(x+1)) in between, followed by the Cephes rational
+		 * approximation. The reductions are selects rather than branches, so loops over lanes vectorize.
+		 * Accurate to about 1 ulp; x = +inf returns pi/2.
+		 */
+		inline double
+		atan_pos(double x)
+		{
+			constexpr double T3P8 = 2.41421356237309504880;
+			constexpr double MOREBITS = 6.123233995736765886130E-17;
+
+			bool big = x > T3P8;
+			bool mid = !big && x > 0.66;
+
+			double y = big ? pi / 2 : (mid ? pi / 4 : 0.0);
+			double m = big ? MOREBITS : (mid ? 0.5 * MOREBITS : 0.0);
+			x = big ? -1.0 / x : (mid ? (x - 1.0) / (x + 1.0) : x);
+
+			double z = x * x;
+			double p = ((((-8.750608600031904122785E-1 * z
+				- 1.615753718733365076637E1) * z
+				- 7.500855792314704667340E1) * z
+				- 1.228866684490136173410E2) * z
+				- 6.485021904942025371773E1);
+			double q = (((((z
+				+ 2.485846490142306297962E1) * z
+				+ 1.650270098316988542046E2) * z
+				+ 4.328810604912902668951E2) * z
+				+ 4.853903996359136964868E2) * z
+				+ 1.945506571482613964425E2);
+
+			z = x * z * p / q + x;
+			return y + (z + m);
+		}
+
+		/**
+		 * \brief Branch-free atan2 for y >= 0, x >= 0, not both zero
+		 */
+		inline double
+		atan2_pos(double y, double x)
+		{
+			return atan_pos(y / x);
+		}
+	}
+
+	/**
+	 * \brief Structure of arrays of independent 3 layer slabs
+	 */
+	struct slab_batch
+	{
+		const double* n1;     ///< box refractive indices
+		const double* n2;     ///< core refractive indices
+		const double* n3;     ///< cladding refractive indices
+		const double* lambda; ///< wavelengths
+		const double* W;      ///< slab thicknesses
+		const int* j;         ///< mode orders
+		size_t size;          ///< number of slabs
+	};
+
+	/**
+	 * \brief Solve a block of at most simd::lanes slabs in lockstep.
+	 *
+	 * Every lane takes a Newton step on slab_equation_fdf, or a bisection step where the Newton
+	 * step leaves its bracket, as a select. A lane is masked off once its step falls below tol,
+	 * and the block finishes when every lane is masked.
+	 * The characteristic equation increases monotonically with neff on [max(n1, n3), n2], so
+	 * the bracket is maintained without orientation.
+	 *
+	 * \param b the slabs
+	 * \param i0 index of the first slab of the block
+	 * \param n number of slabs in the block
+	 * \param neff the effective refractive indices, or min(n1, n3) for modes that are not guided
+	 * \param max_iter maximum number of lockstep iterations
+	 */
+	template<Mode mode>
+	void
+	solve_slab_lanes(const slab_batch& b, size_t i0, size_t n, double* neff, int max_iter = 100)
+	{
+		using simd::lanes;
+
+		alignas(64) double n1[lanes], n3[lanes], n1s[lanes], n2s[lanes], n3s[lanes];
+		alignas(64) double k0[lanes], W[lanes], phase[lanes];
+		alignas(64) double lo[lanes], hi[lanes], x[lanes];
+		alignas(64) int active[lanes], guided[lanes];
+		alignas(64) uint32_t steps[lanes] = {};
+
+		for (size_t l = 0; l < lanes; l++)
+		{
+			// Tail lanes replicate the first slab of the block and start masked
+			size_t i = i0 + ((l < n) ? l : 0);
+			n1[l] = b.n1[i];
+			n3[l] = b.n3[i];
+			n1s[l] = b.n1[i] * b.n1[i];
+			n2s[l] = b.n2[i] * b.n2[i];
+			n3s[l] = b.n3[i] * b.n3[i];
+			k0[l] = 2 * pi / b.lambda[i];
+			W[l] = b.W[i];
+			phase[l] = (b.j[i] + 1) * pi;
+			lo[l] = std::max(n1[l], n3[l]);
+			hi[l] = b.n2[i];
+			active[l] = (l < n) && (lo[l] < hi[l]);
+		}
+
+		// slab_equation_fdf over all lanes
+		auto fdf = [&](const double* xv, double* f, double* df)
+		{
+			for (size_t l = 0; l < lanes; l++)
+			{
+				double xs = xv[l] * xv[l];
+				double k0s = k0[l] * k0[l];
+				double g1 = k0[l] * std::sqrt(std::max(xs - n1s[l], 0.0));
+				double g2 = k0[l] * std::sqrt(std::max(n2s[l] - xs, 0.0));
+				double g3 = k0[l] * std::sqrt(std::max(xs - n3s[l], 0.0));
+
+				double p1 = (mode == TE) ? 1.0 : n1s[l];
+				double p3 = (mode == TE) ? 1.0 : n3s[l];
+				double q = (mode == TE) ? 1.0 : n2s[l];
+
+				f[l] = -simd::atan2_pos(p1 * g2, q * g1) - simd::atan2_pos(p3 * g2, q * g3)
+					+ phase[l] - g2 * W[l];
+
+				double d1 = p1 * q * k0s * xv[l] * (g1 * g1 + g2 * g2) /
+					(g1 * g2 * (q * q * g1 * g1 + p1 * p1 * g2 * g2));
+				double d3 = p3 * q * k0s * xv[l] * (g3 * g3 + g2 * g2) /
+					(g3 * g2 * (q * q * g3 * g3 + p3 * p3 * g2 * g2));
+				df[l] = d1 + d3 + W[l] * k0s * xv[l] / g2;
+			}
+		};
+
+		alignas(64) double f[lanes], df[lanes];
+
+		// A mode is guided if the characteristic equation is negative at the lower bound
+		fdf(lo, f, df);
+		for (size_t l = 0; l < lanes; l++)
+		{
+			guided[l] = active[l] & (f[l] < 0);
+			active[l] = guided[l];
+			x[l] = 0.5 * (lo[l] + hi[l]);
+		}
+
+		for (int iter = 0; iter < max_iter; iter++)
+		{
+			int any = 0;
+			for (size_t l = 0; l < lanes; l++)
+				any |= active[l];
+			if (!any)
+				break;
+
+			fdf(x, f, df);
+
+			for (size_t l = 0; l < lanes; l++)
+			{
+				// Masks are combined bitwise so that the loop has no control flow
+				int below = f[l] < 0;
+				double l_new = below ? x[l] : lo[l];
+				double h_new = below ? hi[l] : x[l];
+
+				double newton = x[l] - f[l] / df[l];
+				int inside = (newton > l_new) & (newton < h_new);
+				// A lane on its root stays there
+				double x_new = (f[l] == 0) ? x[l] : (inside ? newton : 0.5 * (l_new + h_new));
+
+				int step = (std::fabs(x_new - x[l]) > tol) & (f[l] != 0);
+				int a = active[l];
+
+				lo[l] = a ? l_new : lo[l];
+				hi[l] = a ? h_new : hi[l];
+				x[l] = a ? x_new : x[l];
+				steps[l] += a;
+				active[l] = a & step;
+			}
+		}
+
+		for (size_t l = 0; l < n; l++)
+			neff[i0 + l] = guided[l] ? x[l] : std::min(n1[l], n3[l]);
+
+		if (stats::active())
+		{
+			// Each lane is recorded as a run, the residual is that of the last evaluated step
+			for (size_t l = 0; l < n; l++)
+			{
+				opt::Status s;
+				s.status = !guided[l] ? opt::INVALID_RANGE : (active[l] ? opt::DIVERGED : opt::CONVERGED);
+				s.iterations = steps[l];
+				s.evaluations = steps[l] + 1;
+				s.residual = guided[l] ? std::fabs(f[l]) : 0;
+				stats::record(s, stats::HORIZONTAL);
+				if (!guided[l])
+					stats::fallback(stats::HORIZONTAL);
+			}
+		}
+	}
+
+	/**
+	 * \brief Split a batch into blocks of simd::lanes, solved in parallel
+	 * \param size the size of the batch
+	 * \param f callable that solves a block, void f(size_t i0, size_t n)
+	 */
+	template<typename F>
+	void
+	for_each_block(size_t size, F&& f)
+	{
+		std::vector<size_t> blocks((size + simd::lanes - 1) / simd::lanes);
+		std::iota(blocks.begin(), blocks.end(), 0);
+
+		auto solve_block = [&](const size_t& k)
+		{
+			size_t i0 = k * simd::lanes;
+			f(i0, std::min(simd::lanes, size - i0));
+		};
+
+		#if PARALLEL
+			std::for_each(std::execution::par, blocks.begin(), blocks.end(), solve_block);
+		#else
+			std::for_each(blocks.begin(), blocks.end(), solve_block);
+		#endif
+	}
+
+	/**
+	 * \brief Solve a batch of independent 3 layer slabs.
+	 * The batch is split into blocks of simd::lanes slabs solved in lockstep, with the blocks in parallel.
+	 *
+	 * \param b the slabs
+	 * \param neff the effective refractive indices, of size b.size
+	 * \see solve_slab_lanes
+	 */
+	template<Mode mode>
+	void
+	solve_slab_batch(const slab_batch& b, double* neff)
+	{
+		for_each_block(b.size, [&](size_t i0, size_t n) { solve_slab_lanes<mode>(b, i0, n, neff); });
+	}
+
+	/**
+	 * \brief Structure of arrays of independent 5 layer slot slabs, each of one parity
+	 */
+	struct slot_batch
+	{
+		const double* n_clad; ///< cladding refractive indices
+		const double* n_core; ///< rail refractive indices
+		const double* n_slot; ///< slot refractive indices
+		const double* lambda; ///< wavelengths
+		const double* w_slot; ///< slot widths
+		const double* w_core; ///< rail widths
+		const int* j;         ///< mode orders
+		const uint8_t* odd;   ///< 1 for the sinh-type (odd) mode, 0 for the cosh-type (even) mode
+		size_t size;          ///< number of slabs
+	};
+
+	/**
+	 * \brief Solve a block of at most simd::lanes slot slabs in lockstep.
+	 *
+	 * The even and odd modes share the lanes: they differ only in the slot term, gamma t or gamma / t
+	 * of t = tanh(gamma a), which is a select, as are its derivatives gamma' (t + gamma a (1 - t^2))
+	 * and gamma' (t - gamma a (1 - t^2)) / t^2.
+	 * Every lane takes a Newton step, or an Illinois step where the Newton step leaves its bracket, as a select.
+	 * The characteristic equations decrease monotonically with neff on [max(n_clad, n_slot), n_core].
+	 *
+	 * \param b the slot slabs
+	 * \param i0 index of the first slab of the block
+	 * \param n number of slabs in the block
+	 * \param neff the effective refractive indices, or max(n_clad, n_slot) for modes that are not guided
+	 * \param max_iter maximum number of lockstep iterations
+	 * \see slot_cosh_equation, slot_sinh_equation
+	 */
+	inline void
+	solve_slot_lanes(const slot_batch& b, size_t i0, size_t n, double* neff, int max_iter = 100)
+	{
+		using simd::lanes;
+
+		alignas(64) double ncl2[lanes], nc2[lanes], ns2[lanes];
+		alignas(64) double k0[lanes], a[lanes], L[lanes], phase[lanes];
+		alignas(64) double lo[lanes], hi[lanes], flo[lanes], fhi[lanes], x[lanes], nmin[lanes];
+		alignas(64) int active[lanes], guided[lanes], odd[lanes], last[lanes];
+		alignas(64) uint32_t steps[lanes] = {};
+
+		for (size_t l = 0; l < lanes; l++)
+		{
+			// Tail lanes replicate the first slab of the block and start masked
+			size_t i = i0 + ((l < n) ? l : 0);
+			ncl2[l] = b.n_clad[i] * b.n_clad[i];
+			nc2[l] = b.n_core[i] * b.n_core[i];
+			ns2[l] = b.n_slot[i] * b.n_slot[i];
+			k0[l] = 2 * pi / b.lambda[i];
+			a[l] = b.w_slot[i] / 2.0;
+			L[l] = b.w_core[i];
+			phase[l] = b.j[i] * pi;
+			odd[l] = b.odd[i];
+			nmin[l] = std::max(b.n_clad[i], b.n_slot[i]);
+			lo[l] = nmin[l];
+			hi[l] = b.n_core[i];
+			active[l] = (l < n) && (lo[l] < hi[l]);
+		}
+
+		// slot_cosh_equation or slot_sinh_equation over all lanes, with the derivative
+		auto fdf = [&](const double* xv, double* f, double* df)
+		{
+			for (size_t l = 0; l < lanes; l++)
+			{
+				double xs = xv[l] * xv[l];
+				double k0s = k0[l] * k0[l];
+				double gs = k0[l] * std::sqrt(std::max(xs - ns2[l], 0.0));
+				double kc = k0[l] * std::sqrt(std::max(nc2[l] - xs, 0.0));
+				double gc = k0[l] * std::sqrt(std::max(xs - ncl2[l], 0.0));
+
+				double t = std::tanh(gs * a[l]);
+				double dt = gs * a[l] * (1 - t * t);
+				double dgs = k0s * xv[l] / gs;
+				// gamma_slot coth(gamma_slot a) tends to 1/a at neff = n_slot
+				double Y = odd[l] ? ((gs > 0) ? gs / t : 1 / a[l]) : gs * t;
+				double dY = odd[l] ? dgs * (t - dt) / (t * t) : dgs * (t + dt);
+
+				double X1 = ncl2[l] * kc, Y1 = nc2[l] * gc;
+				double X2 = ns2[l] * kc, Y2 = nc2[l] * Y;
+				double dkc = -k0s * xv[l] / kc;
+
+				f[l] = kc * L[l] - simd::atan2_pos(Y1, X1) - simd::atan2_pos(Y2, X2) - phase[l];
+
+				// d/dn atan2(Y, X) = (X Y' - Y X') / (X^2 + Y^2)
+				double d1 = (X1 * nc2[l] * k0s * xv[l] / gc - Y1 * ncl2[l] * dkc) / (X1 * X1 + Y1 * Y1);
+				double d2 = (X2 * nc2[l] * dY - Y2 * ns2[l] * dkc) / (X2 * X2 + Y2 * Y2);
+				df[l] = L[l] * dkc - d1 - d2;
+			}
+		};
+
+		alignas(64) double f[lanes], df[lanes];
+
+		// A mode is guided if the characteristic equation is positive at the lower bound,
+		// and it is negative at n_core, where kappa_core vanishes
+		fdf(hi, fhi, df);
+		fdf(lo, flo, df);
+		for (size_t l = 0; l < lanes; l++)
+		{
+			guided[l] = active[l] & (flo[l] > 0);
+			active[l] = guided[l];
+			x[l] = hi[l] - fhi[l] * (hi[l] - lo[l]) / (fhi[l] - flo[l]);
+			f[l] = flo[l];
+			last[l] = -1;
+		}
+
+		for (int iter = 0; iter < max_iter; iter++)
+		{
+			int any = 0;
+			for (size_t l = 0; l < lanes; l++)
+				any |= active[l];
+			if (!any)
+				break;
+
+			fdf(x, f, df);
+
+			for (size_t l = 0; l < lanes; l++)
+			{
+				// The steep ends of the bracket, at the cutoff and at n_core, throw the Newton step out of it;
+				// the fallback is the Illinois step, which halves the value of an end that is kept twice
+				int above = f[l] > 0;
+				double l_new = above ? x[l] : lo[l];
+				double h_new = above ? hi[l] : x[l];
+				double fl_new = above ? f[l] : flo[l] * ((last[l] == 0) ? 0.5 : 1.0);
+				double fh_new = above ? fhi[l] * ((last[l] == 1) ? 0.5 : 1.0) : f[l];
+
+				double newton = x[l] - f[l] / df[l];
+				int inside = (newton > l_new) & (newton < h_new);
+				double falsi = h_new - fh_new * (h_new - l_new) / (fh_new - fl_new);
+				// A lane on its root stays there
+				double x_new = (f[l] == 0) ? x[l] : (inside ? newton : falsi);
+
+				int step = (std::fabs(x_new - x[l]) > tol) & (f[l] != 0);
+				int on = active[l];
+
+				lo[l] = on ? l_new : lo[l];
+				hi[l] = on ? h_new : hi[l];
+				flo[l] = on ? fl_new : flo[l];
+				fhi[l] = on ? fh_new : fhi[l];
+				last[l] = on ? above : last[l];
+				x[l] = on ? x_new : x[l];
+				steps[l] += on;
+				active[l] = on & step;
+			}
+		}
+
+		for (size_t l = 0; l < n; l++)
+			neff[i0 + l] = guided[l] ? x[l] : nmin[l];
+
+		if (stats::active())
+		{
+			for (size_t l = 0; l < n; l++)
+			{
+				opt::Status s;
+				s.status = !guided[l] ? opt::INVALID_RANGE : (active[l] ? opt::DIVERGED : opt::CONVERGED);
+				s.iterations = steps[l];
+				s.evaluations = steps[l] + 2;
+				s.residual = guided[l] ? std::fabs(f[l]) : 0;
+				stats::record(s, stats::HORIZONTAL);
+				if (!guided[l])
+					stats::fallback(stats::HORIZONTAL);
+			}
+		}
+	}
+
+	/**
+	 * \brief Solve a batch of independent 5 layer slot slabs, in blocks of simd::lanes as solve_slab_batch
+	 * \param b the slot slabs
+	 * \param neff the effective refractive indices, of size b.size
+	 * \see solve_slot_lanes
+	 */
+	inline void
+	solve_slot_batch(const slot_batch& b, double* neff)
+	{
+		for_each_block(b.size, [&](size_t i0, size_t n) { solve_slot_lanes(b, i0, n, neff); });
+	}
+
+	/**
+	 * \brief Solve a strip waveguide sweep with the horizontal stage batched.
+	 *
+	 * The vertical stage depends only on the wavelength, so it is solved once per wavelength of the sweep,
+	 * then every horizontal slab of the sweep is solved by solve_slab_batch. The result matches Strip::operator() at each point.
+	 *
+	 * \param wg the strip waveguide; wavelength, w_rib and mode_order are taken from the sweep
+	 * \param s the sweep
+	 * \param neff the effective refractive indices, indexed as the sweep
+	 */
+	inline void
+	solve_sweep(const Strip& wg, const sweep& s, std::vector<double>& neff)
+	{
+		const size_t N = s.size();
+		// The wavelength is the outermost axis of the sweep, so the points of a wavelength are contiguous
+		const size_t L = std::max<size_t>(s.wavelengths.size(), 1), per = N / L;
+		std::vector<double> v1(L), v2(L);
+		for (size_t k = 0; k < L; k++)
+		{
+			double wavelength = s[k * per].wavelength;
+			// The TE mode of the waveguide is the TM mode of the horizontal slab, of the TE indices of the vertical slabs
+			v1[k] = solve_vertical_mode(wg.mode, wg.n_box, (wg.t_slab ? wg.n_core : wg.n_clad), wg.n_clad, wavelength, wg.t_slab, 0);
+			v2[k] = solve_vertical_mode(wg.mode, wg.n_box, wg.n_core, wg.n_clad, wavelength, wg.t_rib, 0);
+		}
+
+		std::vector<double> n1(N), n2(N), lambda(N), W(N);
+		std::vector<int> j(N);
+		for (size_t i = 0; i < N; i++)
+		{
+			auto p = s[i];
+			n1[i] = v1[i / per];
+			n2[i] = v2[i / per];
+			lambda[i] = p.wavelength;
+			W[i] = p.width;
+			j[i] = p.mode_order;
+		}
+
+		neff.resize(N);
+		stats::timer t(stats::HORIZONTAL);
+		slab_batch b{n1.data(), n2.data(), n1.data(), lambda.data(), W.data(), j.data(), N};
+
+		if (wg.mode == TE)
+			solve_slab_batch<TM>(b, neff.data());
+		else
+			solve_slab_batch<TE>(b, neff.data());
+	}
+
+	/**
+	 * \brief Solve a slot waveguide sweep with the horizontal stage batched.
+	 *
+	 * The vertical stage is solved once per wavelength of the sweep, of the polarization of the mode only,
+	 * then the slot slabs of the sweep are solved by solve_slot_batch. With neff_odd, the even and odd modes
+	 * of each point take adjacent lanes. The result matches waveguide::operator() at each point.
+	 *
+	 * \param wg the slot waveguide; wavelength, w_slot, w_core and mode_order are taken from the sweep
+	 * \param s the sweep
+	 * \param neff the effective refractive indices of the even modes, indexed as the sweep
+	 * \param neff_odd optional effective refractive indices of the odd modes, indexed as the sweep
+	 */
+	inline void
+	solve_sweep(const waveguide& wg, const sweep& s, std::vector<double>& neff, std::vector<double>* neff_odd = nullptr)
+	{
+		const size_t N = s.size();
+		const size_t P = neff_odd ? 2 : 1;
+		// The wavelength is the outermost axis of the sweep, so the points of a wavelength are contiguous
+		const size_t L = std::max<size_t>(s.wavelengths.size(), 1), per = N / L;
+		std::vector<double> clad(L), core(L), slot(L);
+		for (size_t k = 0; k < L; k++)
+		{
+			double wavelength = s[k * per].wavelength;
+			clad[k] = solve_vertical_mode(wg.mode, wg.n_box, wg.n_clad, wg.n_clad, wavelength, wg.t_core, 0);
+			core[k] = solve_vertical_mode(wg.mode, wg.n_box, wg.n_core, wg.n_clad, wavelength, wg.t_core, 0);
+			slot[k] = solve_vertical_mode(wg.mode, wg.n_box, wg.n_slot, wg.n_clad, wavelength, wg.t_core, 0);
+		}
+
+		std::vector<double> n_clad(N * P), n_core(N * P), n_slot(N * P), lambda(N * P), w_slot(N * P), w_core(N * P);
+		std::vector<int> j(N * P);
+		std::vector<uint8_t> odd(N * P);
+		for (size_t i = 0; i < N; i++)
+		{
+			auto p = s[i];
+			for (size_t q = 0; q < P; q++)
+			{
+				size_t r = i * P + q;
+				n_clad[r] = clad[i / per];
+				n_core[r] = core[i / per];
+				n_slot[r] = slot[i / per];
+				lambda[r] = p.wavelength;
+				w_slot[r] = p.gap;
+				w_core[r] = p.width;
+				j[r] = p.mode_order;
+				odd[r] = q;
+			}
+		}
+
+		std::vector<double> n(N * P);
+		{
+			stats::timer t(stats::HORIZONTAL);
+			slot_batch b{n_clad.data(), n_core.data(), n_slot.data(), lambda.data(), w_slot.data(), w_core.data(),
+				j.data(), odd.data(), N * P};
+			solve_slot_batch(b, n.data());
+		}
+
+		neff.resize(N);
+		if (neff_odd)
+			neff_odd->resize(N);
+		for (size_t i = 0; i < N; i++)
+		{
+			neff[i] = n[i * P];
+			if (neff_odd)
+				(*neff_odd)[i] = n[i * P + 1];
+		}
+	}
+
+}//namespace eim
+
+#endif //__BATCH_H__
@@ -0,0 +1,158 @@
+#ifndef __CACHE_H__
+#define __CACHE_H__
+/**
+ * \brief Memoization utilities.
+ * \file cache.h Thread-safe Result Cache Definitions
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace eim
+{
+	/**
+	 * \brief The bit pattern of a key member, with -0.0 taken as +0.0
+	 *
+	 * Keys compare and hash their members by these bits, so that equal keys hash equal:
+	 * -0.0 is the key of 0.0, and a NaN member is equal to itself rather than missing on every lookup.
+	 */
+	inline uint64_t
+	key_bits(double v)
+	{
+		return std::bit_cast<uint64_t>(v + 0.0);
+	}
+
+	/**
+	 * \brief Key of a 3 layer slab solve
+	 */
+	struct slab_key
+	{
+		double n1;     ///< box refractive index
+		double n2;     ///< core refractive index
+		double n3;     ///< cladding refractive index
+		double lambda; ///< wavelength
+		double W;      ///< slab thickness
+		int j;         ///< mode order
+
+		bool
+		operator==(const slab_key& o) const
+		{
+			return key_bits(n1) == key_bits(o.n1) && key_bits(n2) == key_bits(o.n2) && key_bits(n3) == key_bits(o.n3) &&
+				key_bits(lambda) == key_bits(o.lambda) && key_bits(W) == key_bits(o.W) && j == o.j;
+		}
+	};
+
+	/**
+	 * \brief Hash of a slab_key, combining the key_bits of its members
+	 */
+	struct slab_key_hash
+	{
+		size_t
+		operator()(const slab_key& k) const
+		{
+			uint64_t h = 0xcbf29ce484222325ull;
+			auto mix = [&h](uint64_t v)
+			{
+				h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+			};
+			mix(key_bits(k.n1));
+			mix(key_bits(k.n2));
+			mix(key_bits(k.n3));
+			mix(key_bits(k.lambda));
+			mix(key_bits(k.W));
+			mix(static_cast<uint64_t>(k.j));
+			return h;
+		}
+	};
+
+	/**
+	 * \brief Thread-safe memoization of a pure function.
+	 *
+	 * Lookups take a shared lock, so parallel workers only serialize on a miss.
+	 * Concurrent misses on the same key may both evaluate the function; the first result stored is kept.
+	 * The cache holds at most capacity values: a miss on a full cache clears it, so that a long running
+	 * process does not grow without bound, and hits never take the exclusive lock to track recency.
+	 *
+	 * \tparam K the key type
+	 * \tparam V the value type
+	 * \tparam H the hash of the key type
+	 **/
+	template<typename K, typename V, typename H = std::hash<K>>
+	class memo
+	{
+		mutable std::shared_mutex mtx_{};
+		std::unordered_map<K, V, H> map_{};
+		size_t capacity_;
+
+		public:
+		/**
+		 * \param capacity the number of values held before the cache is cleared
+		 **/
+		explicit memo(size_t capacity = SIZE_MAX) : capacity_(capacity) {}
+
+		/**
+		 * \brief return the cached value of key, or evaluate and store it
+		 * \param key the key
+		 * \param f callable evaluating the value on a miss, V f()
+		 * \returns the value of key
+		 **/
+		template<typename F>
+		V
+		operator()(const K& key, F&& f)
+		{
+			{
+				std::shared_lock lock(mtx_);
+				auto it = map_.find(key);
+				if (it != map_.end())
+					return it->second;
+			}
+
+			V v = f();
+
+			std::unique_lock lock(mtx_);
+			if (map_.size() >= capacity_ && !map_.contains(key))
+				map_.clear();
+			return map_.try_emplace(key, v).first->second;
+		}
+
+		size_t
+		size() const
+		{
+			std::shared_lock lock(mtx_);
+			return map_.size();
+		}
+
+		void
+		clear()
+		{
+			std::unique_lock lock(mtx_);
+			map_.clear();
+		}
+	};
+
+}//namespace eim
+
+#endif //__CACHE_H__
@@ -27,10 +27,42 @@
 // THE SOFTWARE.
 
 #include <eim.h>
+#include <grid.h>
+#include <sweep.h>
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstring>
+#include <iterator>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace eim
 {
+	/**
+	 * \brief Columns of the csv mode field output, as a mask
+	 */
+	enum Output:uint8_t
+	{
+		AMPLITUDE = 1,  ///< |A|, of the transverse field
+		E_FIELD = 2,    ///< |E|
+		H_FIELD = 4,    ///< |H|
+		NORMAL = 8,     ///< |Bn|, of the field normal to the lateral dimension
+		INTENSITY = 16, ///< |A|^2
+		PHASE = 32      ///< arg(A)
+	};
+
+	/**
+	 * \brief Names of the outputs, by bit of the mask
+	 */
+	inline constexpr const char* output_names[] = {"amplitude", "E", "H", "normal", "intensity", "phase"};
+
 	struct ctl
 	{
 		//Waveguide Geometry
@@ -51,11 +83,91 @@ namespace eim
 		std::vector<unsigned> mode_orders; ///< Mode orders to solve
 		std::vector<double> widths;      ///< Widths of core layer to solve
 		std::vector<double> gaps;        ///< Slot sizes to solve
+		std::optional<adaptive_range> adaptive_widths;      ///< Range of widths to refine, widths holds its ends
+		std::optional<adaptive_range> adaptive_wavelengths; ///< Range of wavelengths to refine, wavelengths holds its ends
+		bool continuation = false;       ///< Solve sweeps by continuation along the widths
+		std::vector<double> targets;     ///< Target neffs of an inverse solve, NaN for the cutoff
+		Axis unknown = WIDTH;            ///< Unknown of an inverse solve, over the range of its sweep values
 		//Output parameters
 		const char* mode_logname = NULL; ///< Mode output log name
 		bool mode_log = false;           ///< Mode output flag
+		bool mode_binary = false;        ///< Mode output in the binary grid format
+		Element mode_element = COMPLEX_DOUBLE; ///< Element type of the binary mode output
+		uint8_t mode_outputs = AMPLITUDE; ///< Columns of the csv mode output, a mask of Output
+		bool stats_summary = false;      ///< Write the solver statistics at exit
+		bool stats_rows = false;         ///< Write the solver statistics of each point with its neff
+		bool dispersion = false;         ///< Write the group index and dispersion of each point with its neff
+		bool confinement = false;        ///< Write the confinement factors of each point with its neff
+		bool odd_modes = false;          ///< Write the neff of the odd (sinh-type) slot mode of each point with its neff
+		const char* lut_logname = NULL;  ///< Output filename of a neff table over the widths and wavelengths
+		double lut_tol = 1e-6;           ///< Absolute error of the neff table
+		const char* cache = NULL;        ///< Persistent neff cache file, shared by runs and processes
+		//Batch parameters
+		const char* batch = NULL;        ///< Job file of one set of options per line, '-' for stdin
+		//Distribution parameters
+		size_t shard_index = 0;          ///< Shard of the sweep solved by this node
+		size_t shard_count = 0;          ///< Number of shards of the sweep, 0 to solve all of it
+		bool merge = false;              ///< Merge the shard files of the arguments into the neff table
+		//Server parameters
+		bool serve = false;              ///< Serve binary requests until the input is closed
+		const char* serve_socket = NULL; ///< Unix socket of the server, stdin/stdout if not set
 	};
 
+	/**
+	 * \brief Parse the numbers of [first, last) with std::from_chars
+	 *
+	 * The numbers are separated by commas, newlines or blanks, and each ends at a separator or at last.
+	 * The separators are counted first, so that result is sized once for the list.
+	 *
+	 * \tparam T The numeric type
+	 * \param result The list in numeric format
+	 * \param min Optional qualifier for minimum allowable value
+	 * \param max Optional qualifier for maximum allowable value
+	 * \returns the position of the first token that is not a number, or last
+	 * \throws std::runtime_error if a value is out of range or out of bounds
+	 */
+	template<typename T>
+	inline const char*
+	parse_values(const char* first, const char* last, std::vector<T>& result,
+				 std::optional<T> min = std::nullopt,
+				 std::optional<T> max = std::nullopt)
+	{
+		auto separator = [](char c) { return c == ',' || c == '\n' || c == '\r' || c == ' ' || c == '\t'; };
+
+		result.clear();
+		result.reserve(std::count_if(first, last, separator) + 1);
+
+		const char* current = first;
+		while (true)
+		{
+			while (current != last && separator(*current))
+				current++;
+			if (current == last)
+				break;
+
+			// strtod accepted a leading plus, which std::from_chars does not
+			const char* token = current + (*current == '+');
+			T val;
+			auto [end, ec] = std::from_chars(token, last, val);
+			// A number ends at a separator: '1.5-2' is not the two numbers 1.5 and -2
+			if (ec == std::errc::invalid_argument || (end != last && !separator(*end)))
+				break;
+			if (ec == std::errc::result_out_of_range)
+				throw std::runtime_error(std::string(current, end) + " out of range");
+
+			// Check bounds if specified
+			if (min.has_value() && val < min.value())
+				throw std::runtime_error(std::string(current, end) + " out of bounds (below minimum)");
+			if (max.has_value() && val > max.value())
+				throw std::runtime_error(std::string(current, end) + " out of bounds (above maximum)");
+
+			result.push_back(val);
+			current = end;
+		}
+
+		return current;
+	}
+
 	/**
 	 * \brief Parse comma-separated list of numeric types
 	 * 
@@ -64,7 +176,9 @@ namespace eim
 	 * \param result The list in numeric format
 	 * \param min Optional qualifier for minimum allowable value
 	 * \param max Optional qualifier for maximum allowable value
-	 * 
+	 * \returns the number of values
+	 * \throws std::runtime_error if a token is not a number, or a value is out of range or out of bounds
+	 * \see parse_values
 	 */
 	template<typename T>
 	inline size_t 
@@ -79,35 +193,187 @@ namespace eim
 		std::same_as<T, int>
 	)
 	{
-		result.clear();
-		char* end = nullptr;
-		const char* current = str;
-		
-		while (*current)
+		const char* last = str + std::strlen(str);
+		const char* stop = parse_values(str, last, result, min, max);
+		if (stop != last)
+			throw std::runtime_error(std::string(str) + ": not a number at " + stop);
+		return result.size();
+	}
+
+	/**
+	 * \brief Read the values of a sweep axis from a file, mapped read-only
+	 *
+	 * A file named *.bin holds the values as raw doubles, in the byte order of the host;
+	 * any other file holds them as text, separated by newlines, commas or blanks.
+	 *
+	 * \param path The file
+	 * \param values The values of the axis
+	 * \throws std::runtime_error if the file cannot be read, or holds no values or a token that is not a number
+	 */
+	inline void
+	read_values(const std::string& path, std::vector<double>& values)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("could not open " + path);
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
 		{
-			T val;
-			if constexpr (std::is_same_v<T, double>)
-				val = std::strtod(current, &end);
-			else if constexpr (std::is_same_v<T, float>)
-				val = std::strtof(current, &end);
-			else if constexpr (std::is_same_v<T, unsigned>)
-				val = std::strtoul(current, &end, 10);
-			else // int
-				val = std::strtol(current, &end, 10);
-			
-			if (current == end) break;
-			
-			// Check bounds if specified
-			if (min.has_value() && val < min.value())
-				throw std::runtime_error(std::string(str) + " out of bounds (below minimum)");
-			if (max.has_value() && val > max.value())
-				throw std::runtime_error(std::string(str) + " out of bounds (above maximum)");
-			
-			result.push_back(val);
-			current = (*end) ? end + 1 : end;
+			::close(fd);
+			throw std::runtime_error("could not stat " + path);
 		}
-		
-		return result.size();
+		const size_t size = st.st_size;
+
+		const char* data = nullptr;
+		if (size)
+		{
+			void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED)
+			{
+				::close(fd);
+				throw std::runtime_error("could not map " + path);
+			}
+			::madvise(p, size, MADV_SEQUENTIAL);
+			data = static_cast<const char*>(p);
+		}
+		// The mapping outlives the descriptor
+		::close(fd);
+		struct unmap { const char* p; size_t n; ~unmap() { if (p) ::munmap(const_cast<char*>(p), n); } } r{data, size};
+
+		if (path.ends_with(".bin"))
+		{
+			if (size % sizeof(double))
+				throw std::runtime_error(path + ": a binary file holds whole doubles");
+			values.resize(size / sizeof(double));
+			if (size)
+				std::memcpy(values.data(), data, size);
+		}
+		else
+		{
+			const char* stop = parse_values(data, data + size, values);
+			if (stop != data + size)
+				throw std::runtime_error(path + ": not a number at byte " + std::to_string(stop - data));
+		}
+
+		if (values.empty())
+			throw std::runtime_error(path + ": no values");
+	}
+
+	/**
+	 * \brief Parse a comma-separated list of values, or read it from a file of the form '@<file>'
+	 * \throws std::runtime_error if a token is not a number
+	 * \see parse_numeric, read_values
+	 */
+	inline void
+	parse_list(const char* str, std::vector<double>& values)
+	{
+		if (str[0] == '@')
+			read_values(str + 1, values);
+		else
+			parse_numeric<double>(str, values);
+	}
+
+	/**
+	 * \brief Parse the values of a sweep axis: a list, a range of points or an adaptive range
+	 *
+	 * The forms are a comma-separated list, '@<file>' for a list read from a file, 'lo:hi:n' for n uniform points and
+	 * 'lo:hi:adaptive[,tol=<tol>]', for which values holds the ends of the range.
+	 *
+	 * \param str The values in string format
+	 * \param values The values of the axis
+	 * \param adaptive The adaptive range, if it is one
+	 * \throws std::runtime_error if the range is malformed
+	 */
+	inline void
+	parse_axis(const char* str, std::vector<double>& values, std::optional<adaptive_range>& adaptive)
+	{
+		adaptive.reset();
+		std::string s{str};
+		auto c1 = s.find(':');
+		if (c1 == std::string::npos || str[0] == '@')
+		{
+			parse_list(str, values);
+			return;
+		}
+
+		auto c2 = s.find(':', c1 + 1);
+		if (c2 == std::string::npos)
+			throw std::runtime_error(s + ": a range is lo:hi:n or lo:hi:adaptive");
+
+		// A field of the range is one number, with nothing before or after it
+		auto field = [&s]<typename T>(std::string_view f, T& val, const char* what)
+		{
+			if constexpr (std::floating_point<T>)
+				f.remove_prefix(f.starts_with('+'));
+			auto [end, ec] = std::from_chars(f.data(), f.data() + f.size(), val);
+			if (ec == std::errc::result_out_of_range)
+				throw std::runtime_error(s + ": the " + what + " of the range is out of range");
+			if (ec != std::errc{} || end != f.data() + f.size())
+				throw std::runtime_error(s + ": the " + what + " of the range is not a number");
+		};
+
+		std::string_view v{s};
+		double lo, hi;
+		field(v.substr(0, c1), lo, "lower bound");
+		field(v.substr(c1 + 1, c2 - c1 - 1), hi, "upper bound");
+		if (!(lo < hi))
+			throw std::runtime_error(s + ": the range must have lo < hi");
+
+		std::string_view spec = v.substr(c2 + 1);
+		if (spec.starts_with("adaptive"))
+		{
+			adaptive_range r{lo, hi};
+			std::string_view opt = spec.substr(8);
+			if (!opt.empty())
+			{
+				if (!opt.starts_with(",tol="))
+					throw std::runtime_error(s + ": the option of an adaptive range is tol=<tol>");
+				field(opt.substr(5), r.tol, "tolerance");
+				if (!(r.tol > 0))
+					throw std::runtime_error(s + ": the tolerance must be positive");
+			}
+			adaptive = r;
+			values = {lo, hi};
+			return;
+		}
+
+		// std::from_chars takes no sign for an unsigned count, so '-3' is not a number rather than a huge one
+		size_t n;
+		field(spec, n, "number of points");
+		if (n < 2)
+			throw std::runtime_error(s + ": a range has at least 2 points");
+		values.resize(n);
+		for (size_t i = 0; i < n; i++)
+			values[i] = lo + (hi - lo) * i / (n - 1);
+		values.back() = hi;
+	}
+
+	/**
+	 * \brief Parse a comma-separated list of the names of outputs
+	 * \param str The list in string format, e.g. 'amplitude,phase'
+	 * \returns the mask of Output
+	 * \throws std::runtime_error if a name is not an output
+	 */
+	inline uint8_t
+	parse_outputs(const char* str)
+	{
+		uint8_t mask = 0;
+		std::string s{str};
+		size_t start = 0;
+		while (start <= s.size())
+		{
+			size_t end = std::min(s.find(',', start), s.size());
+			std::string name = s.substr(start, end - start);
+			size_t k = 0;
+			while (k < std::size(output_names) && name != output_names[k])
+				k++;
+			if (k == std::size(output_names))
+				throw std::runtime_error(name + ": the outputs are amplitude, E, H, normal, intensity and phase");
+			mask |= 1 << k;
+			start = end + 1;
+		}
+		return mask;
 	}
 
 }//namespace eim
@@ -46,6 +46,8 @@ namespace eim
 	static constexpr double mu0 = 4 * pi * 1E-7; // Henries per meter (H/m)
 	static constexpr double c = 1/sqrt(eps0*mu0); // free space speed of light
 	static constexpr double eta0 = sqrt(mu0/eps0); // free space impedance
+	static constexpr double tol = 1e-10; // tolerance of the effective index root finding
+	static constexpr uint32_t solver_version = 1; // version of the solvers, part of the key of persisted results
 
 	using field_t = std::complex<double>;
 
@@ -66,6 +68,38 @@ namespace eim
 		STRIP,
 		SLOT
 	};
+
+	/**
+	 * \brief Axis of a sweep, e.g. the unknown of an inverse solve
+	 */
+	enum Axis:uint8_t
+	{
+		WAVELENGTH,
+		GAP,
+		WIDTH
+	};
+
+	/**
+	 * \brief Components of a 1D mode profile, a mask of the outputs of mode_1D
+	 */
+	enum Component:uint8_t
+	{
+		TRANSVERSE_FIELD = 1, ///< the transverse field A
+		LATERAL_FIELD = 2,    ///< the orthogonal field along the lateral dimension, Bl
+		NORMAL_FIELD = 4,     ///< the field along the normal dimension, Bn
+		ALL_FIELDS = 7
+	};
+
+	/**
+	 * \brief Refractive indices of the material stack of a waveguide
+	 */
+	struct stack
+	{
+		double n_box;  ///< refractive index of the substrate
+		double n_core; ///< refractive index of the core
+		double n_clad; ///< refractive index of the cladding
+		double n_slot; ///< refractive index of the slot, slot only
+	};
 }//namespace eim
 
 #endif //__EIM_H__
\ No newline at end of file
@@ -0,0 +1,306 @@
+#ifndef __FIELD_H__
+#define __FIELD_H__
+/**
+ * \brief Separable mode fields.
+ * \file field.h Rank-1 2D Field Definitions
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include <eim.h>
+#include <libvec.h>
+
+namespace eim
+{
+	/**
+	 * \brief A 2D field that separates into the product of two 1D profiles.
+	 *
+	 * The effective index method gives field(i, j) = u[i] * v[j], so the N x N field is stored
+	 * as its two factors and evaluated on demand. Dense storage is only produced by materialize,
+	 * and integrals of two separable fields on the same axes factor into products of 1D sums.
+	 *
+	 * \tparam T the element type
+	 **/
+	template<typename T = field_t>
+	struct separable_field
+	{
+		std::vector<double> x; ///< axis of the rows
+		std::vector<double> y; ///< axis of the columns
+		std::vector<T> u;      ///< profile along the rows
+		std::vector<T> v;      ///< profile along the columns
+
+		separable_field() = default;
+
+		/**
+		 * \brief allocate the profiles of a field on the axes x and y
+		 **/
+		template<typename I1, typename I2>
+		separable_field(I1 x1, I1 x2, I2 y1, I2 y2):
+		x(x1, x2),
+		y(y1, y2),
+		u(x.size()),
+		v(y.size())
+		{ }
+
+		/**
+		 * \brief reset the field to the axes x and y, reusing the storage of the profiles
+		 * Once the storage has grown to the axes, a field assigned from point to point does not allocate.
+		 * \returns the field
+		 **/
+		template<typename I1, typename I2>
+		separable_field&
+		assign(I1 x1, I1 x2, I2 y1, I2 y2)
+		{
+			x.assign(x1, x2);
+			y.assign(y1, y2);
+			u.resize(x.size());
+			v.resize(y.size());
+			return *this;
+		}
+
+		size_t rows() const { return u.size(); }
+		size_t cols() const { return v.size(); }
+
+		/**
+		 * \returns the field at row i and column j
+		 **/
+		T
+		operator()(size_t i, size_t j) const
+		{
+			return u[i] * v[j];
+		}
+
+		/**
+		 * \brief evaluate the row i, e.g. to stream it to a writer
+		 * \param out storage of cols() points
+		 **/
+		template<typename U = T>
+		void
+		row(size_t i, U* out) const
+		{
+			const T ui = u[i];
+			for (size_t j = 0; j < v.size(); j++)
+				out[j] = U(ui * v[j]);
+		}
+
+		/**
+		 * \brief evaluate the field tile by tile
+		 *
+		 * Each tile is evaluated into a buffer of tile x tile points, so that the working set stays in cache.
+		 * \param tile the edge of a tile
+		 * \param f callable on each tile, f(i0, j0, rows, cols, const T* tile), where the tile is row-major with a stride of cols
+		 **/
+		template<typename F>
+		void
+		for_each_tile(size_t tile, F&& f) const
+		{
+			// The tile buffer of each thread is kept from call to call
+			thread_local std::vector<T> buf;
+			buf.resize(tile * tile);
+			for (size_t i0 = 0; i0 < rows(); i0 += tile)
+			{
+				size_t ni = std::min(tile, rows() - i0);
+				for (size_t j0 = 0; j0 < cols(); j0 += tile)
+				{
+					size_t nj = std::min(tile, cols() - j0);
+					for (size_t i = 0; i < ni; i++)
+						for (size_t j = 0; j < nj; j++)
+							buf[i * nj + j] = u[i0 + i] * v[j0 + j];
+					f(i0, j0, ni, nj, static_cast<const T*>(buf.data()));
+				}
+			}
+		}
+
+		/**
+		 * \brief evaluate the dense field into contiguous row-major storage
+		 * \param field storage of rows() x cols() points
+		 * \param ld the stride between rows of field
+		 **/
+		void
+		materialize(T* field, size_t ld) const
+		{
+			vec::outer_product<T>(u.begin(), u.end(), v.begin(), v.end(), field, ld);
+		}
+
+		/**
+		 * \brief evaluate the dense field
+		 * \param field the rows of the field, rows() x cols()
+		 **/
+		void
+		materialize(T** field) const
+		{
+			#if PARALLEL
+				vec::async_outer_product<T>(u.begin(), u.end(), v.begin(), v.end(), field);
+			#else
+				vec::outer_product<T>(u.begin(), u.end(), v.begin(), v.end(), field);
+			#endif
+		}
+
+		/**
+		 * \brief overlap integral with the field g on the same axes
+		 * $\iint f^* g \,dx\,dy = \int u_f^* u_g \,dx \int v_f^* v_g \,dy$, by the trapezoidal rule
+		 * \returns the overlap integral
+		 **/
+		T
+		overlap(const separable_field& g) const
+		{
+			return integral(x, u, g.u) * integral(y, v, g.v);
+		}
+
+		/**
+		 * \returns the integral of the intensity, $\iint |f|^2 \,dx\,dy$
+		 **/
+		double
+		power() const
+		{
+			return std::real(overlap(*this));
+		}
+
+		/**
+		 * \brief power coupling to the field g on the same axes, $|\langle f, g \rangle|^2 / (P_f P_g)$
+		 * \returns the coupling efficiency, in [0, 1]
+		 **/
+		double
+		coupling(const separable_field& g) const
+		{
+			return std::norm(overlap(g)) / (power() * g.power());
+		}
+
+		/**
+		 * \brief fraction of the power in the rectangle [x0, x1] x [y0, y1]
+		 * The fraction is the product of the fractions of the 1D profiles, so it is two O(N) reductions.
+		 * \returns the confinement factor of the rectangle
+		 **/
+		double
+		confinement(double x0, double x1, double y0, double y1) const
+		{
+			auto fraction = [](const std::vector<double>& t, const std::vector<T>& a, double t0, double t1)
+			{
+				size_t i0 = std::lower_bound(t.begin(), t.end(), t0) - t.begin();
+				size_t i1 = std::upper_bound(t.begin(), t.end(), t1) - t.begin();
+				return std::real(integral(t, a, a, i0, i1)) / std::real(integral(t, a, a));
+			};
+			return fraction(x, u, x0, x1) * fraction(y, v, y0, y1);
+		}
+
+		private:
+		/**
+		 * \brief trapezoidal integral of conj(a) * b along the axis t, over the points [i0, i1)
+		 * Long axes are reduced in parallel.
+		 **/
+		static T
+		integral(const std::vector<double>& t, const std::vector<T>& a, const std::vector<T>& b,
+			size_t i0 = 0, size_t i1 = SIZE_MAX)
+		{
+			i1 = std::min(i1, t.size());
+			if (i1 < i0 + 2)
+				return T(0);
+
+			auto segment = [&](size_t i)
+			{
+				auto f0 = conj_if(a[i]) * b[i];
+				auto f1 = conj_if(a[i + 1]) * b[i + 1];
+				return (f0 + f1) * (0.5 * (t[i + 1] - t[i]));
+			};
+
+			#if PARALLEL
+			// Below a few thousand points the thread launch costs more than the reduction
+			if (i1 - i0 >= (1 << 14))
+			{
+				std::vector<size_t> segments(i1 - i0 - 1);
+				std::iota(segments.begin(), segments.end(), i0);
+				return std::transform_reduce(std::execution::par, segments.begin(), segments.end(),
+					T(0), std::plus<>(), segment);
+			}
+			#endif
+
+			T sum = 0;
+			for (size_t i = i0; i + 1 < i1; i++)
+				sum += segment(i);
+			return sum;
+		}
+
+		static T
+		conj_if(const T& z)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+				return z;
+			else
+				return std::conj(z);
+		}
+	};
+
+	/**
+	 * \brief the separable field of the calling thread, reused by the solvers from point to point
+	 * The field is reset by separable_field::assign, so that steady state evaluations of the fields do not allocate.
+	 * \returns the field of the calling thread
+	 **/
+	template<typename T = field_t>
+	separable_field<T>&
+	scratch_field()
+	{
+		thread_local separable_field<T> field;
+		return field;
+	}
+
+	/**
+	 * \brief Power of a separable mode by region, from the closed form integrals of its 1D profiles
+	 * \tparam L the number of regions of the lateral profile
+	 **/
+	template<size_t L>
+	struct mode_power
+	{
+		std::array<double, L> lateral;  ///< power of the lateral profile by region, from left to right
+		std::array<double, 3> vertical; ///< power of the vertical profile in the box, core and cladding
+
+		/**
+		 * \returns the power of the mode, $\iint |f|^2 \,dx\,dy$
+		 **/
+		double
+		total() const
+		{
+			return std::accumulate(lateral.begin(), lateral.end(), 0.0) *
+				std::accumulate(vertical.begin(), vertical.end(), 0.0);
+		}
+
+		/**
+		 * \returns the fraction of the power in lateral region i and vertical region j, NaN if the mode is not guided
+		 **/
+		double
+		fraction(size_t i, size_t j) const
+		{
+			double p = total();
+			return std::isfinite(p) ? lateral[i] * vertical[j] / p : std::numeric_limits<double>::quiet_NaN();
+		}
+	};
+
+}//namespace eim
+
+#endif //__FIELD_H__
@@ -0,0 +1,297 @@
+#ifndef __GRID_H__
+#define __GRID_H__
+/**
+ * \brief Binary mode field container.
+ * \file grid.h Binary 2D Field Format Definitions
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <eim.h>
+
+namespace eim
+{
+	/**
+	 * \brief Element type of a binary grid
+	 */
+	enum Element:uint32_t
+	{
+		COMPLEX_DOUBLE, ///< std::complex<double>
+		COMPLEX_FLOAT   ///< std::complex<float>
+	};
+
+	/**
+	 * \brief Header of a binary grid record.
+	 *
+	 * A record is the header, the transverse axis (rows doubles), the lateral axis (cols doubles)
+	 * and the field, rows x cols elements in row-major order. Records of a sweep are concatenated,
+	 * and the next record starts at size bytes from the header. All values are in native byte order.
+	 */
+	struct grid_header
+	{
+		char magic[8] = {'E', 'I', 'M', 'G', 'R', 'I', 'D', '\0'}; ///< file identifier
+		uint32_t version = 1;  ///< format version
+		uint32_t element = COMPLEX_DOUBLE; ///< Element type of the field
+		uint64_t rows = 0;     ///< number of points along the transverse axis
+		uint64_t cols = 0;     ///< number of points along the lateral axis
+		uint64_t size = 0;     ///< size of the record in bytes, header included
+		double t_slab = 0;     ///< thickness of the slab layer
+		double t_rib = 0;      ///< thickness of the rib/core layer
+		double width = 0;      ///< width of the rib/core layer
+		double wavelength = 0; ///< wavelength
+		double neff = 0;       ///< effective refractive index of the mode
+		uint32_t mode = TE;    ///< Mode, TE or TM
+		uint32_t mode_order = 0; ///< mode order
+		double gap = 0;        ///< width of the slot, slot only
+		uint8_t reserved[32] = {}; ///< pads the header to 128 bytes
+	};
+	static_assert(sizeof(grid_header) == 128);
+
+	/**
+	 * \returns the size in bytes of an element
+	 */
+	inline size_t
+	element_size(uint32_t element)
+	{
+		return (element == COMPLEX_FLOAT) ? sizeof(std::complex<float>) : sizeof(std::complex<double>);
+	}
+
+	/**
+	 * \returns the size in bytes of a record with the shape and element type of h
+	 */
+	inline size_t
+	record_size(const grid_header& h)
+	{
+		return sizeof(grid_header) + (h.rows + h.cols) * sizeof(double) + h.rows * h.cols * element_size(h.element);
+	}
+
+	/**
+	 * \brief A record of a mapped grid file
+	 */
+	template<typename B>
+	struct grid_record
+	{
+		B* base; ///< address of the header, B is std::byte or const std::byte
+
+		/// T, const if the record is read-only
+		template<typename T>
+		using element_t = std::conditional_t<std::is_const_v<B>, const T, T>;
+
+		element_t<grid_header>* header() const { return reinterpret_cast<element_t<grid_header>*>(base); }
+		element_t<double>* x() const { return reinterpret_cast<element_t<double>*>(base + sizeof(grid_header)); }
+		element_t<double>* y() const { return x() + header()->rows; }
+
+		/**
+		 * \returns the field of elements T, rows x cols in row-major order
+		 **/
+		template<typename T>
+		element_t<T>* field() const { return reinterpret_cast<element_t<T>*>(y() + header()->cols); }
+	};
+
+	/**
+	 * \brief Grid file mapped for writing.
+	 *
+	 * The file is created with the blocks of its final size, as count records of the same shape and element type,
+	 * and mapped shared so that fields are computed in place rather than copied from a matrix.
+	 * Each record header and axes are written on construction.
+	 */
+	class grid_file
+	{
+		int fd_{-1};
+		std::byte* data_{nullptr};
+		size_t size_{0};
+		size_t record_{0};
+
+		public:
+		/**
+		 * \param path the file name
+		 * \param h the header of the records, without geometry
+		 * \param count the number of records
+		 * \param x the transverse axis, of h.rows points
+		 * \param y the lateral axis, of h.cols points
+		 **/
+		grid_file(const std::string& path, grid_header h, size_t count, const double* x, const double* y)
+		{
+			h.size = record_size(h);
+			record_ = h.size;
+			size_ = count * h.size;
+
+			fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (fd_ < 0)
+				throw std::runtime_error("could not open " + path);
+			// The blocks are reserved, so that a full disk fails here rather than with SIGBUS on a write of the mapping
+			int err = size_ ? ::posix_fallocate(fd_, 0, size_) : 0;
+			if (err == EOPNOTSUPP)
+				err = ::ftruncate(fd_, size_) != 0;
+			if (err)
+			{
+				::close(fd_);
+				throw std::runtime_error("could not size " + path);
+			}
+
+			if (size_)
+			{
+				void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+				if (p == MAP_FAILED)
+				{
+					::close(fd_);
+					throw std::runtime_error("could not map " + path);
+				}
+				data_ = static_cast<std::byte*>(p);
+			}
+
+			for (size_t k = 0; k < count; k++)
+			{
+				auto r = (*this)[k];
+				std::memcpy(r.header(), &h, sizeof(h));
+				std::memcpy(r.x(), x, h.rows * sizeof(double));
+				std::memcpy(r.y(), y, h.cols * sizeof(double));
+			}
+		}
+
+		grid_file(const grid_file&) = delete;
+		grid_file& operator=(const grid_file&) = delete;
+
+		~grid_file()
+		{
+			if (data_)
+				::munmap(data_, size_);
+			if (fd_ >= 0)
+				::close(fd_);
+		}
+
+		/**
+		 * \returns the record k
+		 **/
+		grid_record<std::byte>
+		operator[](size_t k)
+		{
+			return {data_ + k * record_};
+		}
+
+		size_t
+		size() const
+		{
+			return record_ ? size_ / record_ : 0;
+		}
+	};
+
+	/**
+	 * \brief Grid file mapped read-only.
+	 * Records are located by their sizes on construction, and each size must be that of the shape
+	 * and element type of its header; nothing else is parsed.
+	 */
+	class grid_view
+	{
+		int fd_{-1};
+		const std::byte* data_{nullptr};
+		size_t size_{0};
+		std::vector<size_t> offsets_{};
+
+		public:
+		explicit grid_view(const std::string& path)
+		{
+			fd_ = ::open(path.c_str(), O_RDONLY);
+			if (fd_ < 0)
+				throw std::runtime_error("could not open " + path);
+
+			struct stat st;
+			if (::fstat(fd_, &st) != 0)
+			{
+				::close(fd_);
+				throw std::runtime_error("could not stat " + path);
+			}
+			size_ = st.st_size;
+
+			if (size_)
+			{
+				void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+				if (p == MAP_FAILED)
+				{
+					::close(fd_);
+					throw std::runtime_error("could not map " + path);
+				}
+				data_ = static_cast<const std::byte*>(p);
+			}
+
+			// A record must hold whole its shape, so the axes and field stay within the mapping
+			grid_header expected;
+			for (size_t off = 0; off < size_;)
+			{
+				auto h = reinterpret_cast<const grid_header*>(data_ + off);
+				size_t n = (size_ - off) / sizeof(double);
+				bool ok = off + sizeof(grid_header) <= size_ &&
+					std::memcmp(h->magic, expected.magic, sizeof(expected.magic)) == 0 &&
+					(h->element == COMPLEX_DOUBLE || h->element == COMPLEX_FLOAT) &&
+					h->rows <= n && h->cols <= n && (h->rows == 0 || h->cols <= n / h->rows) &&
+					h->size == record_size(*h) && off + h->size <= size_;
+				if (!ok)
+				{
+					::munmap(const_cast<std::byte*>(data_), size_);
+					::close(fd_);
+					throw std::runtime_error(path + " is not a grid file");
+				}
+				offsets_.push_back(off);
+				off += h->size;
+			}
+		}
+
+		grid_view(const grid_view&) = delete;
+		grid_view& operator=(const grid_view&) = delete;
+
+		~grid_view()
+		{
+			if (data_)
+				::munmap(const_cast<std::byte*>(data_), size_);
+			if (fd_ >= 0)
+				::close(fd_);
+		}
+
+		/**
+		 * \returns the record k
+		 **/
+		grid_record<const std::byte>
+		operator[](size_t k) const
+		{
+			return {data_ + offsets_[k]};
+		}
+
+		size_t
+		size() const
+		{
+			return offsets_.size();
+		}
+	};
+
+}//namespace eim
+
+#endif //__GRID_H__
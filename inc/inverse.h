@@ -0,0 +1,129 @@
+#ifndef __INVERSE_H__
+#define __INVERSE_H__
+/**
+ * \brief Inverse solves.
+ * \file inverse.h Geometry and Wavelength of a Target Effective Index, and Cutoffs
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include <eim.h>
+#include <libopt.h>
+#include <sweep.h>
+
+namespace eim
+{
+	/**
+	 * \brief A target of an inverse solve that asks for the cutoff of the mode
+	 */
+	static constexpr double cutoff = std::numeric_limits<double>::quiet_NaN();
+
+	/**
+	 * \brief Solve neff(x) = target over [lo, hi], by an outer Brent run over the inner solves
+	 * \param neff callable double neff(double x)
+	 * \param s statistics of the outer run
+	 * \param tol tolerance on x
+	 * \returns x, or NaN if [lo, hi] does not bracket the target
+	 */
+	template<typename F>
+	double
+	invert(F&& neff, double target, double lo, double hi, opt::Status& s, double tol = 1e-9)
+	{
+		double x = opt::brent([&](double x) { return neff(x) - target; }, lo, hi, s, tol);
+		return (s.status == opt::CONVERGED) ? x : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	/**
+	 * \brief Solve for the x over [lo, hi] at which the mode is cut off
+	 *
+	 * A mode that is not guided takes the index of the outer regions, so the cutoff is the transition
+	 * of neff(x) > floor(x) and is found by bisection of that predicate.
+	 *
+	 * \param neff callable double neff(double x)
+	 * \param floor callable double floor(double x), the index of a mode that is not guided
+	 * \param s statistics of the outer run
+	 * \param tol tolerance on x
+	 * \returns x, or NaN if the mode is guided, or not, over all of [lo, hi]
+	 */
+	template<typename F, typename G>
+	double
+	find_cutoff(F&& neff, G&& floor, double lo, double hi, opt::Status& s, double tol = 1e-9)
+	{
+		auto guided = [&](double x) { return (neff(x) > floor(x)) ? 1.0 : -1.0; };
+		double x = opt::bisection(guided, lo, hi, s, tol);
+		return (s.status == opt::CONVERGED) ? x : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	/**
+	 * \brief Solve the unknown of every point of a sweep for every target, in parallel.
+	 *
+	 * Each solve is an outer root finder over the unknown, so that a query costs a few dozen
+	 * solves of the waveguide, with the vertical stage answered from the vertical cache.
+	 *
+	 * \param s the sweep, with the axis of the unknown empty
+	 * \param axis the unknown
+	 * \param lo the lower bound of the unknown
+	 * \param hi the upper bound of the unknown
+	 * \param targets the target effective indices, or cutoff
+	 * \param neff callable double neff(const point&)
+	 * \param floor callable double floor(const point&), the index of a mode that is not guided
+	 * \param x the solutions, indexed by point * targets.size() + target, NaN if there is none in [lo, hi]
+	 */
+	template<typename F, typename G>
+	void
+	solve_inverse(const sweep& s, Axis axis, double lo, double hi, const std::vector<double>& targets,
+		F&& neff, G&& floor, std::vector<double>& x)
+	{
+		const size_t T = targets.size();
+		x.resize(s.size() * T);
+		std::vector<size_t> tasks(x.size());
+		std::iota(tasks.begin(), tasks.end(), 0);
+
+		auto solve = [&](const size_t& k)
+		{
+			point p = s[k / T];
+			double target = targets[k % T];
+			auto at = [&](double xi) { point q = p; set(q, axis, xi); return q; };
+			auto n = [&](double xi) { return neff(at(xi)); };
+
+			opt::Status st;
+			if (std::isnan(target))
+				x[k] = find_cutoff(n, [&](double xi) { return floor(at(xi)); }, lo, hi, st);
+			else
+				x[k] = invert(n, target, lo, hi, st);
+		};
+
+		#if PARALLEL
+			std::for_each(std::execution::par, tasks.begin(), tasks.end(), solve);
+		#else
+			std::for_each(tasks.begin(), tasks.end(), solve);
+		#endif
+	}
+
+}//namespace eim
+
+#endif //__INVERSE_H__
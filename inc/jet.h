@@ -0,0 +1,156 @@
+#ifndef __JET_H__
+#define __JET_H__
+/**
+ * \brief Forward mode differentiation.
+ * \file jet.h Second Order Jets and Implicit Differentiation of Roots
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <limits>
+
+/**
+ * \brief The jets live in their own namespace, so that the functions of the jets do not hide
+ * the functions of double within the templates of eim, and are found by argument dependent lookup.
+ */
+namespace eim::ad
+{
+	/**
+	 * \brief A value with its first and second derivatives along one parameter
+	 */
+	struct jet2
+	{
+		double v = 0;  ///< value
+		double d = 0;  ///< first derivative
+		double dd = 0; ///< second derivative
+
+		jet2() = default;
+		constexpr jet2(double v, double d = 0, double dd = 0): v(v), d(d), dd(dd) { }
+	};
+
+	/**
+	 * \brief Chain rule of a function h of one jet, from h(x), h'(x) and h''(x)
+	 */
+	inline jet2
+	chain(const jet2& x, double h, double dh, double ddh)
+	{
+		return {h, dh * x.d, ddh * x.d * x.d + dh * x.dd};
+	}
+
+	inline jet2 operator-(const jet2& a) { return {-a.v, -a.d, -a.dd}; }
+	inline jet2 operator+(const jet2& a, const jet2& b) { return {a.v + b.v, a.d + b.d, a.dd + b.dd}; }
+	inline jet2 operator-(const jet2& a, const jet2& b) { return {a.v - b.v, a.d - b.d, a.dd - b.dd}; }
+
+	inline jet2
+	operator*(const jet2& a, const jet2& b)
+	{
+		return {a.v * b.v, a.d * b.v + a.v * b.d, a.dd * b.v + 2 * a.d * b.d + a.v * b.dd};
+	}
+
+	inline jet2
+	operator/(const jet2& a, const jet2& b)
+	{
+		double r = 1 / b.v;
+		return a * chain(b, r, -r * r, 2 * r * r * r);
+	}
+
+	inline jet2 operator+(const jet2& a, double b) { return {a.v + b, a.d, a.dd}; }
+	inline jet2 operator+(double a, const jet2& b) { return b + a; }
+	inline jet2 operator-(const jet2& a, double b) { return {a.v - b, a.d, a.dd}; }
+	inline jet2 operator-(double a, const jet2& b) { return {a - b.v, -b.d, -b.dd}; }
+	inline jet2 operator*(const jet2& a, double b) { return {a.v * b, a.d * b, a.dd * b}; }
+	inline jet2 operator*(double a, const jet2& b) { return b * a; }
+	inline jet2 operator/(const jet2& a, double b) { return a * (1 / b); }
+	inline jet2 operator/(double a, const jet2& b) { return jet2(a) / b; }
+
+	inline jet2
+	sqrt(const jet2& x)
+	{
+		double s = std::sqrt(x.v);
+		return chain(x, s, 0.5 / s, -0.25 / (s * x.v));
+	}
+
+	inline jet2
+	pow(const jet2& x, int n)
+	{
+		if (n == 0)
+			return jet2(1);
+		return chain(x, std::pow(x.v, n), n * std::pow(x.v, n - 1), n * (n - 1) * std::pow(x.v, n - 2));
+	}
+
+	inline jet2
+	tanh(const jet2& x)
+	{
+		double t = std::tanh(x.v);
+		double s = 1 - t * t;
+		return chain(x, t, s, -2 * t * s);
+	}
+
+	inline jet2
+	atan2(const jet2& y, const jet2& x)
+	{
+		// atan2(y, x) has the differential (x dy - y dx) / (x^2 + y^2), differentiated once more
+		double r = x.v * x.v + y.v * y.v;
+		double v = std::atan2(y.v, x.v);
+		double num = x.v * y.d - y.v * x.d;
+		double d = num / r;
+		double dnum = x.v * y.dd - y.v * x.dd; // the cross terms x' y' cancel
+		double dr = 2 * (x.v * x.d + y.v * y.d);
+		double dd = (dnum * r - num * dr) / (r * r);
+		return {v, d, dd};
+	}
+
+	inline bool operator<(const jet2& a, const jet2& b) { return a.v < b.v; }
+
+	/**
+	 * \brief Derivatives of a root along the parameter of the jets.
+	 *
+	 * With F(n(x), x) = 0 at the root n0, implicit differentiation gives
+	 * $n' = -F_x / F_n$ and $n'' = -(F_{nn} n'^2 + 2 F_{nx} n' + F_{xx}) / F_n$.
+	 * The partials are read from three evaluations of F on jets: n = (n0, 0, 0) gives F_x,
+	 * n = (n0, 1, 0) gives F_n + F_x, and n = (n0, n', 0) gives the numerator of n'' as its
+	 * second derivative.
+	 *
+	 * \param f callable jet2 f(jet2 n), the characteristic equation with its parameters as jets
+	 * \param n0 the root
+	 * \returns the root with its derivatives, NaN derivatives if F_n vanishes
+	 */
+	template<typename F>
+	jet2
+	implicit(F&& f, double n0)
+	{
+		double Fx = f(jet2(n0, 0)).d;
+		double Fn = f(jet2(n0, 1)).d - Fx;
+		if (Fn == 0 || !std::isfinite(Fn))
+		{
+			constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+			return {n0, nan, nan};
+		}
+
+		double dn = -Fx / Fn;
+		double ddn = -f(jet2(n0, dn)).dd / Fn;
+		return {n0, dn, ddn};
+	}
+
+}//namespace eim::ad
+
+#endif //__JET_H__
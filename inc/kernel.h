@@ -0,0 +1,101 @@
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+/**
+ * \brief Specialized solver kernels.
+ * \file kernel.h Solver Kernels of Fixed Device and Mode
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <optional>
+#include <eim.h>
+#include <libopt.h>
+#include <strip.h>
+#include <slot.h>
+#include <sweep.h>
+
+namespace eim
+{
+	/**
+	 * \brief The solver of one device and mode, over the points of a sweep.
+	 *
+	 * The device and the mode are template parameters, so that the characteristic equation and
+	 * the root finder of a sweep are one instantiation with no branching on the device or the mode per point.
+	 *
+	 * \tparam device STRIP or SLOT
+	 * \tparam mode TE or TM
+	 */
+	template<Waveguide device, Mode mode>
+	struct kernel
+	{
+		stack m;       ///< the material stack
+		double t_core; ///< thickness of the rib/core layer
+		double t_slab; ///< thickness of the slab layer, strip only
+
+		/**
+		 * \brief calculate the effective refractive index of a point of a sweep
+		 * \param seed optional bracket of the effective refractive index of the horizontal stage
+		 * \returns the effective refractive index
+		 **/
+		double
+		operator()(const point& p, const std::optional<opt::bracket>& seed = std::nullopt) const
+		{
+			if constexpr (device == STRIP)
+				return strip_neff<mode>(m, t_core, t_slab, p.wavelength, p.width, p.mode_order, seed);
+			else
+				return slot_neff<mode>(m, t_core, p.wavelength, p.width, p.gap, p.mode_order, seed);
+		}
+	};
+
+	/**
+	 * \brief Dispatch once to the instantiation of a mode
+	 * \param f a template callable, f.template operator()<mode>()
+	 * \returns the result of f
+	 */
+	template<typename F>
+	decltype(auto)
+	dispatch(Mode mode, F&& f)
+	{
+		if (mode == TE)
+			return f.template operator()<TE>();
+		else
+			return f.template operator()<TM>();
+	}
+
+	/**
+	 * \brief Dispatch once to the kernel of a device, by its mode
+	 * \tparam device STRIP or SLOT
+	 * \param f a callable of the kernel, f(const kernel<device, mode>&)
+	 * \returns the result of f
+	 */
+	template<Waveguide device, typename F>
+	decltype(auto)
+	with_kernel(Mode mode, const stack& m, double t_core, double t_slab, F&& f)
+	{
+		return dispatch(mode, [&]<Mode M>() -> decltype(auto)
+		{
+			return f(kernel<device, M>{m, t_core, t_slab});
+		});
+	}
+
+}//namespace eim
+
+#endif //__KERNEL_H__
@@ -27,7 +27,9 @@
 
 #include <cmath>
 #include <limits>
-#include <functional>
+#include <cstdint>
+#include <tuple>
+#include <utility>
 #include <iostream>
 
 namespace opt
@@ -45,9 +47,19 @@ namespace opt
 	{
 		uint8_t status; ///< Indicates if run Converged or Diverged
 		uint32_t iterations; ///< Number of iterations used
+		uint32_t evaluations; ///< Number of function evaluations used
 		double residual; ///< residual at final run 
 	}__attribute__((packed));
 
+	/**
+	 * \brief Interval expected to contain a root.
+	 **/
+	struct bracket
+	{
+		double lo; ///< left boundary of the interval
+		double hi; ///< right boundary of the interval
+	};
+
 	/**
 	 * \brief Bisection method to find the root of a function.
 	 *
@@ -55,44 +67,51 @@ namespace opt
 	 * within a given interval [a, b]. The method iterates until the desired tolerance
 	 * or the maximum number of iterations is reached.
 	 *
-	 * \param func The function whose root is sought, represented as a std::function.
+	 * \param f The function whose root is sought, any callable double f(double).
 	 * \param a The left boundary of the interval.
 	 * \param b The right boundary of the interval.
-	 * \param tol Tolerance for the root approximation (default is 1e-6).
+	 * \param s Statistics of the run
+	 * \param tol Tolerance for the root approximation (default is 1e-4).
 	 * \param max_iter Maximum number of iterations (default is 100).
 	 * \return The approximated root or NaN if convergence fails.
 	 */
+	template<typename F>
 	double 
-	bisection(const std::function<double(double)>& f, 
-			 double a, double b, Status& s, const double tol = 1e-4, const int max_iter = 100) 
+	bisection(F&& f, double a, double b, Status& s, const double tol = 1e-4, const int max_iter = 100) 
 	{
-		double fa = f(a);
-		double fb = f(b);
+		uint32_t evals = 0;
+		auto g = [&](double x) { evals++; return f(x); };
+
+		double fa = g(a);
+		double fb = g(b);
 
 		if (fa * fb > 0) 
 		{
 			s.status = INVALID_RANGE;
 			s.iterations = 0;
+			s.evaluations = evals;
 			s.residual = std::min(std::fabs(fa), std::fabs(fb));
 			return a;
 		}
 
 		double midpoint, fmid;
 		int iter = 0;
+		const double a0 = a, b0 = b;
 		double* pa = &a, *pb = &b, *pmid = &midpoint;
 
 		*pmid = (*pa + *pb) / 2.0;
-		fmid = f(*pmid);
+		fmid = g(*pmid);
 		
-		while (*pmid > tol && std::fabs(fmid) > tol && iter < max_iter)
+		while ((*pb - *pa) / 2.0 > tol && std::fabs(fmid) > tol && iter < max_iter)
 		{
 			*pmid = (*pa + *pb) / 2.0;
-			fmid = f(*pmid);
+			fmid = g(*pmid);
 			
 			if (std::fabs(fmid) < tol) 
 			{
 				s.status = CONVERGED;
 				s.iterations = iter;
+				s.evaluations = evals;
 				s.residual = std::fabs(fmid);
 				return *pmid;
 			}
@@ -111,9 +130,10 @@ namespace opt
 		}
 
 		*pmid = (*pa + *pb) / 2.0;
-		fmid = f(*pmid);
+		fmid = g(*pmid);
 
 		s.iterations = iter;
+		s.evaluations = evals;
 		s.residual = std::fabs(fmid);
 
 		if ((*pb - *pa) / 2.0 <= tol) 
@@ -125,7 +145,8 @@ namespace opt
 			s.status = DIVERGED;
 		}
 
-		if (std::fabs(*pmid - b) < tol || std::fabs(*pmid - a) < tol) 
+		// A root on the boundary of the original interval is not a root of the interior
+		if (std::fabs(*pmid - b0) < tol || std::fabs(*pmid - a0) < tol) 
 		{
 			s.status = DIVERGED;
 		}
@@ -133,5 +154,285 @@ namespace opt
 		return *pmid;
 	}
 
+	/**
+	 * \brief Check that [a, b] brackets a root.
+	 * \returns true if f(a) and f(b) differ in sign; otherwise fills s with INVALID_RANGE
+	 */
+	inline bool
+	bracketed(double fa, double fb, Status& s)
+	{
+		if (std::signbit(fa) != std::signbit(fb) || fa == 0 || fb == 0)
+			return true;
+
+		s.status = INVALID_RANGE;
+		s.iterations = 0;
+		s.evaluations = 2; // f(a) and f(b)
+		s.residual = std::min(std::fabs(fa), std::fabs(fb));
+		return false;
+	}
+
+	/**
+	 * \brief Brent's method to find the root of a function.
+	 *
+	 * Combines inverse quadratic interpolation and the secant method, falling back to
+	 * bisection whenever the interpolated step is not contracting the bracket [a, b].
+	 * The bracket is retained throughout, so the method is as robust as bisection
+	 * with superlinear convergence near the root.
+	 *
+	 * \param f The function whose root is sought, any callable double f(double).
+	 * \param a The left boundary of the interval.
+	 * \param b The right boundary of the interval.
+	 * \param s Statistics of the run
+	 * \param tol Tolerance on the root (default is 1e-10).
+	 * \param max_iter Maximum number of iterations (default is 100).
+	 * \return The approximated root, or a if [a, b] does not bracket a root.
+	 */
+	template<typename F>
+	double
+	brent(F&& f, double a, double b, Status& s, const double tol = 1e-10, const int max_iter = 100)
+	{
+		uint32_t evals = 0;
+		auto g = [&](double x) { evals++; return f(x); };
+
+		double fa = g(a);
+		double fb = g(b);
+
+		if (!bracketed(fa, fb, s))
+			return a;
+
+		double c = a, fc = fa;
+		double d = b - a, e = d;
+		uint32_t iter = 0;
+
+		for (; iter < static_cast<uint32_t>(max_iter); iter++)
+		{
+			if (std::signbit(fb) == std::signbit(fc) && fb != 0)
+			{
+				c = a; fc = fa;
+				d = b - a; e = d;
+			}
+			if (std::fabs(fc) < std::fabs(fb))
+			{
+				a = b; b = c; c = a;
+				fa = fb; fb = fc; fc = fa;
+			}
+
+			double tol1 = 2.0 * std::numeric_limits<double>::epsilon() * std::fabs(b) + 0.5 * tol;
+			double m = 0.5 * (c - b);
+
+			if (std::fabs(m) <= tol1 || fb == 0)
+			{
+				s.status = CONVERGED;
+				s.iterations = iter;
+				s.evaluations = evals;
+				s.residual = std::fabs(fb);
+				return b;
+			}
+
+			if (std::fabs(e) >= tol1 && std::fabs(fa) > std::fabs(fb))
+			{
+				// Interpolation: secant if only two distinct points, otherwise inverse quadratic
+				double p, q, r;
+				double t = fb / fa;
+				if (a == c)
+				{
+					p = 2.0 * m * t;
+					q = 1.0 - t;
+				}
+				else
+				{
+					q = fa / fc;
+					r = fb / fc;
+					p = t * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+					q = (q - 1.0) * (r - 1.0) * (t - 1.0);
+				}
+				if (p > 0) q = -q;
+				else p = -p;
+
+				if (2.0 * p < std::min(3.0 * m * q - std::fabs(tol1 * q), std::fabs(e * q)))
+				{
+					e = d;
+					d = p / q;
+				}
+				else
+				{
+					d = m; e = d;
+				}
+			}
+			else
+			{
+				d = m; e = d;
+			}
+
+			a = b; fa = fb;
+			b += (std::fabs(d) > tol1) ? d : std::copysign(tol1, m);
+			fb = g(b);
+		}
+
+		s.status = DIVERGED;
+		s.iterations = iter;
+		s.evaluations = evals;
+		s.residual = std::fabs(fb);
+		return b;
+	}
+
+	/**
+	 * \brief Illinois (modified regula falsi) method to find the root of a function.
+	 *
+	 * The false position step is taken on the bracket [a, b]. When the same boundary is retained
+	 * twice in a row its function value is halved, which avoids the one-sided stagnation of
+	 * plain regula falsi. The search stops once the bracket is within tol, as brent.
+	 *
+	 * \param f The function whose root is sought, any callable double f(double).
+	 * \param a The left boundary of the interval.
+	 * \param b The right boundary of the interval.
+	 * \param s Statistics of the run
+	 * \param tol Tolerance on the root (default is 1e-10).
+	 * \param max_iter Maximum number of iterations (default is 100).
+	 * \return The approximated root, or a if [a, b] does not bracket a root.
+	 */
+	template<typename F>
+	double
+	illinois(F&& f, double a, double b, Status& s, const double tol = 1e-10, const int max_iter = 100)
+	{
+		uint32_t evals = 0;
+		auto g = [&](double x) { evals++; return f(x); };
+
+		double fa = g(a);
+		double fb = g(b);
+
+		if (!bracketed(fa, fb, s))
+			return a;
+
+		int side = 0;
+		double c = b, fc = fb;
+		uint32_t iter = 0;
+
+		for (; iter < static_cast<uint32_t>(max_iter); iter++)
+		{
+			c = (a * fb - b * fa) / (fb - fa);
+			fc = g(c);
+
+			if (fc != 0)
+			{
+				if (std::signbit(fc) == std::signbit(fb))
+				{
+					b = c; fb = fc;
+					if (side == -1) fa /= 2;
+					side = -1;
+				}
+				else
+				{
+					a = c; fa = fc;
+					if (side == +1) fb /= 2;
+					side = +1;
+				}
+			}
+
+			// Only the bracket bounds the error: successive false position points can be close far from the root
+			if (fc == 0 || std::fabs(b - a) <= tol)
+			{
+				s.status = CONVERGED;
+				s.iterations = iter;
+				s.evaluations = evals;
+				s.residual = std::fabs(fc);
+				return c;
+			}
+		}
+
+		s.status = DIVERGED;
+		s.iterations = iter;
+		s.evaluations = evals;
+		s.residual = std::fabs(fc);
+		return c;
+	}
+
+	/**
+	 * \brief Safeguarded Newton method to find the root of a function.
+	 *
+	 * Newton steps are taken from the midpoint of the bracket [a, b] using the analytic derivative.
+	 * A bisection step is taken instead whenever the Newton step would leave the bracket,
+	 * would not halve the previous step, or the derivative is not finite.
+	 *
+	 * \param fdf The function and its derivative, any callable std::pair<double, double> fdf(double).
+	 * \param a The left boundary of the interval.
+	 * \param b The right boundary of the interval.
+	 * \param s Statistics of the run
+	 * \param tol Tolerance on the root (default is 1e-10).
+	 * \param max_iter Maximum number of iterations (default is 100).
+	 * \return The approximated root, or a if [a, b] does not bracket a root.
+	 */
+	template<typename FDF>
+	double
+	newton(FDF&& fdf, double a, double b, Status& s, const double tol = 1e-10, const int max_iter = 100)
+	{
+		uint32_t evals = 0;
+		auto g = [&](double x) { evals++; return fdf(x); };
+
+		auto [fa, dfa] = g(a);
+		auto [fb, dfb] = g(b);
+
+		if (!bracketed(fa, fb, s))
+			return a;
+
+		if (fa == 0 || fb == 0)
+		{
+			s.status = CONVERGED;
+			s.iterations = 0;
+			s.evaluations = evals;
+			s.residual = 0;
+			return (fa == 0) ? a : b;
+		}
+
+		// Orient the bracket such that f(lo) < 0 < f(hi)
+		double lo = (fa < 0) ? a : b;
+		double hi = (fa < 0) ? b : a;
+
+		double x = 0.5 * (a + b);
+		double dx_old = std::fabs(b - a);
+		double dx = dx_old;
+		auto [fx, dfx] = g(x);
+		uint32_t iter = 0;
+
+		for (; iter < static_cast<uint32_t>(max_iter); iter++)
+		{
+			bool outside = ((x - hi) * dfx - fx) * ((x - lo) * dfx - fx) > 0;
+			bool slow = std::fabs(2.0 * fx) > std::fabs(dx_old * dfx);
+
+			if (outside || slow || !std::isfinite(dfx))
+			{
+				dx_old = dx;
+				dx = 0.5 * (hi - lo);
+				x = lo + dx;
+			}
+			else
+			{
+				dx_old = dx;
+				dx = fx / dfx;
+				x -= dx;
+			}
+
+			std::tie(fx, dfx) = g(x);
+
+			if (std::fabs(dx) <= tol || fx == 0)
+			{
+				s.status = CONVERGED;
+				s.iterations = iter + 1;
+				s.evaluations = evals;
+				s.residual = std::fabs(fx);
+				return x;
+			}
+
+			if (fx < 0) lo = x;
+			else hi = x;
+		}
+
+		s.status = DIVERGED;
+		s.iterations = iter;
+		s.evaluations = evals;
+		s.residual = std::fabs(fx);
+		return x;
+	}
+
 }
 #endif //__LIB_OPT_H__
\ No newline at end of file
@@ -27,8 +27,16 @@
 
 #include <vector>
 #include <numeric>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <type_traits>
 #include <eim.h>
 
+#if defined(__SSE2__)
+	#include <immintrin.h>
+#endif
+
 namespace vec
 {
 	 /** 
@@ -97,6 +105,161 @@ namespace vec
 	}
 	#endif
 
+	namespace detail
+	{
+		static constexpr size_t tile_rows = 32;  ///< rows of a block of the outer product
+		static constexpr size_t tile_cols = 256; ///< columns of a block, 4 KiB of complex<double> from b
+		static constexpr size_t parallel_threshold = 1 << 16; ///< elements above which blocks are solved in parallel
+		static constexpr size_t stream_threshold = 1 << 24;   ///< bytes above which stores bypass the cache
+
+		template<typename T>
+		struct is_complex : std::false_type {};
+
+		template<typename T>
+		struct is_complex<std::complex<T>> : std::true_type {};
+
+		/**
+		 * \brief c[j] = a * b[j] for j < n.
+		 * Complex products are expanded on the real and imaginary parts, so the loop vectorizes
+		 * without the NaN recovery of std::complex operator*.
+		 */
+		template<typename T>
+		inline void
+		scale_row(T a, const T* b, T* c, size_t n)
+		{
+			if constexpr (is_complex<T>::value)
+			{
+				using R = typename T::value_type;
+				const R ar = a.real(), ai = a.imag();
+				const R* bp = reinterpret_cast<const R*>(b);
+				R* cp = reinterpret_cast<R*>(c);
+				for (size_t j = 0; j < n; j++)
+				{
+					R br = bp[2 * j], bi = bp[2 * j + 1];
+					cp[2 * j] = ar * br - ai * bi;
+					cp[2 * j + 1] = ar * bi + ai * br;
+				}
+			}
+			else
+			{
+				for (size_t j = 0; j < n; j++)
+					c[j] = a * b[j];
+			}
+		}
+
+		/**
+		 * \brief copy n elements with non-temporal stores where the row is 16 byte aligned
+		 * Elements of 8 bytes, e.g. std::complex<float>, are stored in pairs; src must be 16 byte aligned.
+		 */
+		template<typename T>
+		inline void
+		stream_row(const T* src, T* dst, size_t n)
+		{
+			#if defined(__SSE2__)
+			if constexpr (sizeof(T) == 16)
+			{
+				if (reinterpret_cast<uintptr_t>(dst) % 16 == 0)
+				{
+					const double* s = reinterpret_cast<const double*>(src);
+					double* d = reinterpret_cast<double*>(dst);
+					for (size_t j = 0; j < n; j++)
+						_mm_stream_pd(d + 2 * j, _mm_load_pd(s + 2 * j));
+					return;
+				}
+			}
+			else if constexpr (sizeof(T) == 8)
+			{
+				if (reinterpret_cast<uintptr_t>(dst) % 16 == 0)
+				{
+					const float* s = reinterpret_cast<const float*>(src);
+					float* d = reinterpret_cast<float*>(dst);
+					size_t j = 0;
+					for (; j + 2 <= n; j += 2)
+						_mm_stream_ps(d + 2 * j, _mm_load_ps(s + 2 * j));
+					std::copy(src + j, src + n, dst + j);
+					return;
+				}
+			}
+			#endif
+			std::copy(src, src + n, dst);
+		}
+
+		/**
+		 * \brief Blocked outer product into rows addressed by row(i)
+		 *
+		 * The rows are split into blocks of tile_rows, and the columns into tiles of tile_cols, so that the
+		 * tile of b stays in L1 while it is reused by every row of the block. Grids larger than
+		 * stream_threshold are written with non-temporal stores, since they do not fit in cache anyway.
+		 */
+		template<typename T, typename R>
+		void
+		outer_rows(const T* a, size_t rows, const T* b, size_t cols, R&& row, [[maybe_unused]] bool parallel)
+		{
+			const bool stream = rows * cols * sizeof(T) >= stream_threshold;
+
+			auto solve_block = [&](const size_t& k)
+			{
+				alignas(64) T tile[tile_cols];
+				size_t i1 = std::min(rows, (k + 1) * tile_rows);
+				for (size_t j0 = 0; j0 < cols; j0 += tile_cols)
+				{
+					size_t n = std::min(tile_cols, cols - j0);
+					for (size_t i = k * tile_rows; i < i1; i++)
+					{
+						if (stream)
+						{
+							scale_row(a[i], b + j0, tile, n);
+							stream_row(tile, row(i) + j0, n);
+						}
+						else
+							scale_row(a[i], b + j0, row(i) + j0, n);
+					}
+				}
+			};
+
+			std::vector<size_t> blocks((rows + tile_rows - 1) / tile_rows);
+			std::iota(blocks.begin(), blocks.end(), 0);
+
+			#if PARALLEL
+			if (parallel)
+				std::for_each(std::execution::par, blocks.begin(), blocks.end(), solve_block);
+			else
+			#endif
+				std::for_each(blocks.begin(), blocks.end(), solve_block);
+
+			#if defined(__SSE2__)
+			if (stream)
+				_mm_sfence();
+			#endif
+		}
+	}
+
+	 /** \brief A Utility for taking the outer product of vectors into contiguous storage.
+	 *
+	 *	Optionally specify the type (T) of the vectors a, b, with outer_product<T>(...) 
+	 *	Requires that a and b are contiguous storage.
+	 *	The product is blocked for cache, and solved in parallel if it exceeds detail::parallel_threshold
+	 *	elements, so that small products do not pay for the thread launch.
+	 *	\param a1 base address of a
+	 *	\param a2 end address of a	
+	 *	\param b1 base address of b
+	 *	\param b2 end address of b
+	 *  \param c row-major storage of rank 2, shape a x b
+	 *  \param ldc the stride between rows of c, at least the size of b
+	 */
+	template <typename T = double, typename I1, typename I2>
+	void 
+	outer_product(I1 a1, I1 a2, I2 b1, I2 b2, T* c, size_t ldc) 
+	{
+		size_t rows = std::distance(a1, a2);
+		size_t cols = std::distance(b1, b2);
+		const T* a = &(*a1);
+		const T* b = &(*b1);
+
+		detail::outer_rows(a, rows, b, cols, [&c, &ldc](size_t i) { return c + i * ldc; },
+			rows * cols >= detail::parallel_threshold);
+	}
+
 	 /** \brief A Utility for taking the outer product of vectors.
 	 *
 	 *	Optionally specify the type (T) of the vectors a, b, with outer_product<T>(...) 
@@ -113,12 +276,10 @@ namespace vec
 	{
 		size_t rows = std::distance(a1, a2);
 		size_t cols = std::distance(b1, b2);
-		const auto a = &(*a1);
-		const auto b = &(*b1);
+		const T* a = &(*a1);
+		const T* b = &(*b1);
 
-		for (size_t i = 0; i < rows; ++i)
-			for (size_t j = 0; j < cols; ++j)
-				c[i][j] = a[i] * b[j];
+		detail::outer_rows(a, rows, b, cols, [&c](size_t i) { return c[i]; }, false);
 	}
 
 	#if PARALLEL
@@ -138,16 +299,10 @@ namespace vec
 	{
 		size_t rows = std::distance(a1, a2);
 		size_t cols = std::distance(b1, b2);
-		const auto a = &(*a1);
-		const auto b = &(*b1);
+		const T* a = &(*a1);
+		const T* b = &(*b1);
 
-		std::for_each(std::execution::par, a1, a2,
-		[&a, &b, &c, &cols](const auto& ai) 
-		{
-			size_t i = &ai - &a[0];
-			for (size_t j = 0; j < cols; ++j)
-				c[i][j] = ai * (*(b + j));
-		});
+		detail::outer_rows(a, rows, b, cols, [&c](size_t i) { return c[i]; }, true);
 	}
 	#endif
 }
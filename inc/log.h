@@ -1,10 +1,10 @@
 #ifndef __LOG_H__
 #define __LOG_H__
-/** 
+/**
  * \file 	log.h
 * \brief 	definition for log
 * \author 	c. papakonstantinou
-* \date 	March 2023 
+* \date 	March 2023
 **/
 // Copyright (c) 2025  Constantine Papakonstantinou
 //
@@ -26,43 +26,156 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include <fstream>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <iomanip>
 
+/**
+ * \brief Delimited text log with a user-space buffer.
+ *
+ * Rows are formatted with std::to_chars into a buffer that is written to the stream only when full,
+ * so a newline does not flush. Floating point values are written fixed with 6 digits by default;
+ * Log::general selects the shortest of fixed and scientific with a precision, as printf's %g.
+ * Raw bytes may be written with write, for binary formats.
+ * A failed write of the stream is kept, and reported by flush.
+ **/
 class Log
 {
 	bool newline_{true};
 	std::string delim_{};
-	std::ofstream log_{};
-	
+	std::FILE* log_{nullptr};
+	bool owned_{false};
+	std::vector<char> buf_{};
+	size_t used_{0};
+	int error_{0}; ///< errno of the first failed write, 0 if none
+
 	public:
-	explicit Log(std::string log_file, std::string delim=" "):
-	log_(log_file),
-	delim_(delim)
+	static constexpr size_t buffer_size = 1 << 20; ///< bytes buffered before a write
+
+	/**
+	 * \brief a floating point value with its format
+	 **/
+	struct number
+	{
+		double value;
+		std::chars_format format;
+		int precision;
+	};
+
+	/**
+	 * \brief format x as printf's %.<precision>g
+	 **/
+	static number
+	general(double x, int precision)
+	{
+		return {x, std::chars_format::general, precision};
+	}
+
+	/**
+	 * \brief format x as printf's %.<precision>f
+	 **/
+	static number
+	fixed(double x, int precision)
+	{
+		return {x, std::chars_format::fixed, precision};
+	}
+
+	explicit Log(std::string log_file, std::string delim=" ", const char* mode="w"):
+	delim_(delim),
+	log_(std::fopen(log_file.c_str(), mode)),
+	owned_(true),
+	buf_(buffer_size)
+	{
+		if (!log_)
+			throw std::runtime_error("could not open " + log_file);
+	}
+
+	/**
+	 * \brief log to an open stream, e.g. stdout, which is flushed but not closed
+	 **/
+	explicit Log(std::FILE* stream, std::string delim=" "):
+	delim_(delim),
+	log_(stream),
+	buf_(buffer_size)
 	{ }
 
-	~Log() 
+	Log(const Log&) = delete;
+	Log& operator=(const Log&) = delete;
+
+	~Log()
 	{
-		if (log_.is_open())
-			log_.close();
+		try
+		{
+			flush();
+		}
+		catch(const std::exception& ex)
+		{
+			std::fprintf(stderr, "[ERROR] log: %s\n", ex.what());
+		}
+		if (owned_ && log_)
+			std::fclose(log_);
 	}
-	
+
+	/**
+	 * \brief write the buffer to the stream
+	 * \throws std::runtime_error if a write of the stream failed, e.g. of a full disk or a closed pipe;
+	 * the failure is reported once
+	 **/
+	void flush()
+	{
+		if (used_)
+			emit(buf_.data(), used_);
+		used_ = 0;
+		if (std::fflush(log_) != 0 && !error_)
+			error_ = errno ? errno : EIO;
+		if (error_)
+		{
+			int error = std::exchange(error_, 0);
+			throw std::runtime_error(std::string("could not write the log: ") + std::strerror(error));
+		}
+	}
+
+	/**
+	 * \brief append n raw bytes
+	 **/
+	void write(const void* data, size_t n)
+	{
+		if (used_ + n > buf_.size())
+		{
+			emit(buf_.data(), used_);
+			used_ = 0;
+			if (n > buf_.size())
+			{
+				emit(data, n);
+				return;
+			}
+		}
+		std::memcpy(buf_.data() + used_, data, n);
+		used_ += n;
+	}
+
 	void newline()
 	{
-		log_ << std::endl;
+		put("\n");
 		newline_ = true;
 	}
 
 	template<typename T>
 	friend Log& operator<<(Log& olog, T&& x)
 	{
-		if( olog.newline_ ) 
+		if( olog.newline_ )
 			olog.newline_ = false;
-		else olog.log_ << olog.delim_;
+		else olog.put(olog.delim_);
 
-		olog.log_ << std::fixed  << x;
+		olog.format(std::forward<T>(x));
 
 		return olog;
 	}
@@ -71,6 +184,75 @@ class Log
 	{
 		this->newline();
 	}
+
+	private:
+	/**
+	 * \brief write n bytes to the stream, keeping a failure for flush
+	 **/
+	void emit(const void* data, size_t n)
+	{
+		if (std::fwrite(data, 1, n, log_) != n && !error_)
+			error_ = errno ? errno : EIO;
+	}
+
+	void put(std::string_view s)
+	{
+		write(s.data(), s.size());
+	}
+
+	/**
+	 * \brief reserve n bytes at the end of the buffer
+	 **/
+	char* reserve(size_t n)
+	{
+		if (used_ + n > buf_.size())
+		{
+			emit(buf_.data(), used_);
+			used_ = 0;
+		}
+		return buf_.data() + used_;
+	}
+
+	template<typename... A>
+	void convert(A... args)
+	{
+		// 32 bytes holds any integer, and a double to 6 digits unless it exceeds 1e18
+		constexpr size_t n = 32;
+		char* p = reserve(n);
+		auto [end, ec] = std::to_chars(p, p + n, args...);
+		if (ec == std::errc())
+		{
+			used_ += end - p;
+			return;
+		}
+		std::vector<char> large(400);
+		auto [e, _] = std::to_chars(large.data(), large.data() + large.size(), args...);
+		write(large.data(), e - large.data());
+	}
+
+	template<typename T>
+	void format(T&& x)
+	{
+		using U = std::remove_cvref_t<T>;
+		if constexpr (std::is_same_v<U, number>)
+			convert(x.value, x.format, x.precision);
+		else if constexpr (std::is_same_v<U, bool>)
+			put(x ? "1" : "0");
+		else if constexpr (std::is_same_v<U, char>)
+			put(std::string_view(&x, 1));
+		else if constexpr (std::is_floating_point_v<U>)
+			convert(x, std::chars_format::fixed, 6);
+		else if constexpr (std::is_integral_v<U>)
+			convert(x);
+		else if constexpr (std::is_convertible_v<T, std::string_view>)
+			put(std::string_view(x));
+		else
+		{
+			std::ostringstream ss;
+			ss << std::fixed << x;
+			put(ss.str());
+		}
+	}
 };
 
-#endif //__LOG_H__
\ No newline at end of file
+#endif //__LOG_H__
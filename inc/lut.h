@@ -0,0 +1,414 @@
+#ifndef __LUT_H__
+#define __LUT_H__
+/**
+ * \brief Effective index tables.
+ * \file lut.h Adaptive Chebyshev Interpolant of neff over Width and Wavelength
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <eim.h>
+
+namespace eim
+{
+	/**
+	 * \brief Header of a neff table file.
+	 * The header is followed by the nodes of the quadtree, then the coefficients of the leaves.
+	 */
+	struct lut_header
+	{
+		char magic[8] = {'E', 'I', 'M', 'L', 'U', 'T', '\0', '\0'}; ///< file identifier
+		uint32_t version = 1;    ///< format version
+		uint32_t degree = 7;     ///< degree of the Chebyshev series of a leaf, along each axis
+		double w0 = 0, w1 = 0;   ///< width range of the table
+		double l0 = 0, l1 = 0;   ///< wavelength range of the table
+		double tol = 0;          ///< requested absolute error
+		double error = 0;        ///< largest error measured over the check points of the leaves
+		uint64_t nodes = 0;      ///< number of nodes of the quadtree
+		uint64_t leaves = 0;     ///< number of leaves of the quadtree
+		double t_slab = 0;       ///< thickness of the slab layer
+		double t_rib = 0;        ///< thickness of the rib/core layer
+		uint32_t mode = TE;      ///< Mode, TE or TM
+		uint32_t mode_order = 0; ///< mode order
+		uint8_t reserved[24] = {}; ///< pads the header to 128 bytes
+	};
+	static_assert(sizeof(lut_header) == 128);
+
+	/**
+	 * \brief Piecewise Chebyshev interpolant of neff(width, wavelength).
+	 *
+	 * The box is split into a quadtree. Each leaf holds the tensor Chebyshev series of degree
+	 * h.degree that interpolates neff at the Chebyshev points of the leaf. A leaf is split while
+	 * the series misses neff by more than the tolerance at a second grid of check points, which
+	 * includes the edges of the leaf; near the cutoff of a mode, where neff has a kink, this refines
+	 * down to max_depth. The error of the table, h.error, is the largest miss over the check points
+	 * of the leaves, and is a sampled bound rather than a proof.
+	 *
+	 * A query descends the tree, at most max_depth levels, and sums one series, with the
+	 * derivative along the wavelength for the group index.
+	 */
+	struct neff_lut
+	{
+		static constexpr uint32_t max_degree = 15;
+
+		lut_header h;                ///< the table header
+		std::vector<int32_t> nodes;  ///< first child of a node, or -(leaf + 1) for a leaf
+		std::vector<double> coeffs;  ///< (degree + 1)^2 coefficients per leaf, row-major in (width, wavelength)
+
+		/**
+		 * \brief Sample f adaptively over a box
+		 *
+		 * The cells of each level of the tree are fitted in parallel.
+		 * \param f callable neff f(width, wavelength)
+		 * \param h the box, tolerance, degree and the description of the waveguide of the table
+		 * \param max_depth deepest refinement of the quadtree
+		 * \returns the table
+		 */
+		template<typename F>
+		static neff_lut
+		build(F&& f, const lut_header& h, unsigned max_depth = 12)
+		{
+			if (h.degree < 1 || h.degree > max_degree)
+				throw std::runtime_error("lut: degree must be in [1, " + std::to_string(max_degree) + "]");
+			if (!(h.w1 > h.w0) || !(h.l1 > h.l0))
+				throw std::runtime_error("lut: the box must have a positive extent");
+
+			neff_lut lut;
+			lut.h = h;
+			lut.h.error = 0;
+			const size_t n = h.degree + 1;
+
+			struct cell
+			{
+				size_t node;          ///< index of the node of the cell
+				double w0, w1, l0, l1; ///< bounds of the cell
+				unsigned depth;       ///< depth of the cell
+				std::vector<double> c; ///< fitted coefficients
+				double error;         ///< measured error of the fit
+			};
+
+			std::vector<cell> level{{0, h.w0, h.w1, h.l0, h.l1, 0, {}, 0}};
+			lut.nodes.push_back(0);
+
+			while (!level.empty())
+			{
+				auto fit = [&](cell& k)
+				{
+					k.c = fit_cell(f, k.w0, k.w1, k.l0, k.l1, n, k.error);
+				};
+
+				#if PARALLEL
+					std::for_each(std::execution::par, level.begin(), level.end(), fit);
+				#else
+					std::for_each(level.begin(), level.end(), fit);
+				#endif
+
+				std::vector<cell> next;
+				for (auto& k : level)
+				{
+					if (k.error > h.tol && k.depth < max_depth)
+					{
+						// Children in the order (w, l): low low, high low, low high, high high
+						double wm = 0.5 * (k.w0 + k.w1), lm = 0.5 * (k.l0 + k.l1);
+						size_t first = lut.nodes.size();
+						lut.nodes[k.node] = static_cast<int32_t>(first);
+						lut.nodes.resize(first + 4, 0);
+						next.push_back({first + 0, k.w0, wm, k.l0, lm, k.depth + 1, {}, 0});
+						next.push_back({first + 1, wm, k.w1, k.l0, lm, k.depth + 1, {}, 0});
+						next.push_back({first + 2, k.w0, wm, lm, k.l1, k.depth + 1, {}, 0});
+						next.push_back({first + 3, wm, k.w1, lm, k.l1, k.depth + 1, {}, 0});
+					}
+					else
+					{
+						size_t leaf = lut.coeffs.size() / (n * n);
+						lut.nodes[k.node] = -static_cast<int32_t>(leaf) - 1;
+						lut.coeffs.insert(lut.coeffs.end(), k.c.begin(), k.c.end());
+						lut.h.error = std::max(lut.h.error, k.error);
+					}
+				}
+				level = std::move(next);
+			}
+
+			lut.h.nodes = lut.nodes.size();
+			lut.h.leaves = lut.coeffs.size() / (n * n);
+			return lut;
+		}
+
+		/**
+		 * \returns the interpolated effective refractive index, the point is clamped to the box
+		 */
+		double
+		operator()(double width, double wavelength) const
+		{
+			return eval(width, wavelength, nullptr);
+		}
+
+		/**
+		 * \returns the derivative of the interpolant along the wavelength
+		 */
+		double
+		dneff_dlambda(double width, double wavelength) const
+		{
+			double d;
+			eval(width, wavelength, &d);
+			return d;
+		}
+
+		/**
+		 * \returns the group index, $n_g = n_{eff} - \lambda \partial n_{eff} / \partial \lambda$
+		 */
+		double
+		group_index(double width, double wavelength) const
+		{
+			double d;
+			double neff = eval(width, wavelength, &d);
+			return neff - wavelength * d;
+		}
+
+		/**
+		 * \brief write the table to a file
+		 * \throws std::runtime_error if the file cannot be written
+		 */
+		void
+		save(const std::string& path) const
+		{
+			FILE* fp = std::fopen(path.c_str(), "wb");
+			if (!fp)
+				throw std::runtime_error("could not open " + path);
+			bool ok = std::fwrite(&h, sizeof(h), 1, fp) == 1 &&
+				std::fwrite(nodes.data(), sizeof(int32_t), nodes.size(), fp) == nodes.size() &&
+				std::fwrite(coeffs.data(), sizeof(double), coeffs.size(), fp) == coeffs.size();
+			ok &= (std::fclose(fp) == 0);
+			if (!ok)
+				throw std::runtime_error("could not write " + path);
+		}
+
+		/**
+		 * \brief read a table from a file
+		 *
+		 * The sizes of the header must be those of the file, and the tree is checked so that eval
+		 * stays in bounds: every child index follows its node, with its four children within the nodes,
+		 * and every leaf index is below h.leaves.
+		 *
+		 * \throws std::runtime_error if the file is not a table
+		 */
+		static neff_lut
+		load(const std::string& path)
+		{
+			FILE* fp = std::fopen(path.c_str(), "rb");
+			if (!fp)
+				throw std::runtime_error("could not open " + path);
+
+			long size = (std::fseek(fp, 0, SEEK_END) == 0) ? std::ftell(fp) : -1;
+			std::rewind(fp);
+
+			neff_lut lut;
+			const lut_header reference;
+			bool ok = size >= long(sizeof(lut.h)) && std::fread(&lut.h, sizeof(lut.h), 1, fp) == 1 &&
+				std::memcmp(lut.h.magic, reference.magic, sizeof(reference.magic)) == 0 &&
+				lut.h.version == reference.version &&
+				lut.h.degree >= 1 && lut.h.degree <= max_degree &&
+				lut.h.nodes >= 1 && lut.h.nodes <= uint64_t(INT32_MAX) && lut.h.leaves <= lut.h.nodes;
+			if (ok)
+			{
+				size_t n = lut.h.degree + 1;
+				ok = size_t(size) == sizeof(lut.h) + lut.h.nodes * sizeof(int32_t) + lut.h.leaves * n * n * sizeof(double);
+			}
+			if (ok)
+			{
+				size_t n = lut.h.degree + 1;
+				lut.nodes.resize(lut.h.nodes);
+				lut.coeffs.resize(lut.h.leaves * n * n);
+				ok = std::fread(lut.nodes.data(), sizeof(int32_t), lut.nodes.size(), fp) == lut.nodes.size() &&
+					std::fread(lut.coeffs.data(), sizeof(double), lut.coeffs.size(), fp) == lut.coeffs.size();
+			}
+			std::fclose(fp);
+
+			// Every node holds its first child, after it as the tree is built breadth first, or -(leaf + 1)
+			for (size_t i = 0; ok && i < lut.nodes.size(); i++)
+			{
+				int64_t v = lut.nodes[i];
+				if (v >= 0)
+					ok = v > int64_t(i) && uint64_t(v) + 3 < lut.h.nodes;
+				else
+					ok = uint64_t(-(v + 1)) < lut.h.leaves;
+			}
+			if (!ok)
+				throw std::runtime_error(path + " is not a neff table");
+			return lut;
+		}
+
+		private:
+		/**
+		 * \brief Chebyshev polynomials T_0..T_{n-1} at t, and their derivatives if dT is set
+		 * \tparam N the number of polynomials if known at compile time, otherwise 0 and n is used
+		 */
+		template<size_t N = 0>
+		static void
+		chebyshev(double t, size_t n, double* T, double* dT)
+		{
+			if constexpr (N)
+				n = N;
+			T[0] = 1;
+			T[1] = t;
+			for (size_t k = 2; k < n; k++)
+				T[k] = 2 * t * T[k - 1] - T[k - 2];
+
+			if (!dT)
+				return;
+			dT[0] = 0;
+			dT[1] = 1;
+			for (size_t k = 2; k < n; k++)
+				dT[k] = 2 * T[k - 1] + 2 * t * dT[k - 1] - dT[k - 2];
+		}
+
+		/**
+		 * \brief interpolate the tensor series of n x n coefficients c at (t, s) in [-1, 1]^2
+		 * \param ds the derivative along s, if set
+		 * \tparam N n if known at compile time, otherwise 0
+		 */
+		template<size_t N = 0>
+		static double
+		series(const double* c, size_t n, double t, double s, double* ds = nullptr)
+		{
+			if constexpr (N)
+				n = N;
+			double Tt[max_degree + 1], Ts[max_degree + 1], dTs[max_degree + 1];
+			chebyshev<N>(t, n, Tt, nullptr);
+			chebyshev<N>(s, n, Ts, ds ? dTs : nullptr);
+
+			double sum = 0, dsum = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				double row = 0;
+				for (size_t j = 0; j < n; j++)
+					row += c[i * n + j] * Ts[j];
+				sum += Tt[i] * row;
+			}
+			if (!ds)
+				return sum;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				double row = 0;
+				for (size_t j = 0; j < n; j++)
+					row += c[i * n + j] * dTs[j];
+				dsum += Tt[i] * row;
+			}
+			*ds = dsum;
+			return sum;
+		}
+
+		/**
+		 * \brief Fit the series that interpolates f at the Chebyshev points of a cell
+		 * \param error the largest miss at the check points of the cell
+		 * \returns the n x n coefficients
+		 */
+		template<typename F>
+		static std::vector<double>
+		fit_cell(F& f, double w0, double w1, double l0, double l1, size_t n, double& error)
+		{
+			// Chebyshev points of the first kind, and the polynomials at the points
+			std::vector<double> t(n), A(n * n);
+			for (size_t k = 0; k < n; k++)
+				t[k] = std::cos(pi * (k + 0.5) / n);
+			for (size_t i = 0; i < n; i++)
+				for (size_t k = 0; k < n; k++)
+					A[i * n + k] = (i ? 2.0 : 1.0) / n * std::cos(pi * i * (k + 0.5) / n);
+
+			auto to_w = [&](double x) { return 0.5 * (w0 + w1) + 0.5 * (w1 - w0) * x; };
+			auto to_l = [&](double x) { return 0.5 * (l0 + l1) + 0.5 * (l1 - l0) * x; };
+
+			std::vector<double> V(n * n), B(n * n, 0.0), C(n * n, 0.0);
+			for (size_t k = 0; k < n; k++)
+				for (size_t m = 0; m < n; m++)
+					V[k * n + m] = f(to_w(t[k]), to_l(t[m]));
+
+			// C = A V A^T
+			for (size_t i = 0; i < n; i++)
+				for (size_t k = 0; k < n; k++)
+					for (size_t m = 0; m < n; m++)
+						B[i * n + m] += A[i * n + k] * V[k * n + m];
+			for (size_t i = 0; i < n; i++)
+				for (size_t j = 0; j < n; j++)
+					for (size_t m = 0; m < n; m++)
+						C[i * n + j] += B[i * n + m] * A[j * n + m];
+
+			// Check points of the second kind interleave the interpolation points and include the edges
+			error = 0;
+			for (size_t k = 0; k <= n; k++)
+			{
+				double tk = std::cos(pi * k / n);
+				for (size_t m = 0; m <= n; m++)
+				{
+					double sm = std::cos(pi * m / n);
+					error = std::max(error, std::fabs(series(C.data(), n, tk, sm) - f(to_w(tk), to_l(sm))));
+				}
+			}
+			return C;
+		}
+
+		/**
+		 * \brief interpolate at a point, and the derivative along the wavelength if d is set
+		 */
+		double
+		eval(double width, double wavelength, double* d) const
+		{
+			double w = std::clamp(width, h.w0, h.w1);
+			double l = std::clamp(wavelength, h.l0, h.l1);
+			double w0 = h.w0, w1 = h.w1, l0 = h.l0, l1 = h.l1;
+
+			int32_t node = nodes[0];
+			while (node >= 0)
+			{
+				double wm = 0.5 * (w0 + w1), lm = 0.5 * (l0 + l1);
+				int hw = w >= wm, hl = l >= lm;
+				(hw ? w0 : w1) = wm;
+				(hl ? l0 : l1) = lm;
+				node = nodes[node + hw + 2 * hl];
+			}
+
+			const size_t n = h.degree + 1;
+			const double* c = coeffs.data() + size_t(-node - 1) * n * n;
+			double t = (2 * w - w0 - w1) / (w1 - w0);
+			double s = (2 * l - l0 - l1) / (l1 - l0);
+
+			// The default degree is unrolled
+			double ds = 0;
+			double sum = (n == 8) ? series<8>(c, n, t, s, d ? &ds : nullptr) : series(c, n, t, s, d ? &ds : nullptr);
+			if (d)
+				*d = ds * 2 / (l1 - l0);
+			return sum;
+		}
+	};
+
+}//namespace eim
+
+#endif //__LUT_H__
@@ -0,0 +1,370 @@
+#ifndef __SERVE_H__
+#define __SERVE_H__
+/**
+ * \brief Resident solver.
+ * \file serve.h Request/Response Protocol of the Effective Index Server
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <eim.h>
+#include <strip.h>
+#include <slot.h>
+
+namespace eim
+{
+	/**
+	 * \brief A query of the effective refractive index.
+	 *
+	 * Requests and responses are fixed size records in native byte order. A client may pipeline
+	 * any number of requests; the responses are written in the order of the requests of its stream.
+	 * The fields follow Strip for a strip, and waveguide for a slot, where t_core is the
+	 * rib/core thickness, width the rib/core width and gap the slot width.
+	 */
+	struct request
+	{
+		uint32_t id;         ///< identifier returned with the response
+		uint8_t device;      ///< Waveguide, STRIP or SLOT
+		uint8_t mode;        ///< Mode, TE or TM
+		uint16_t mode_order; ///< mode order
+		double wavelength;   ///< wavelength
+		double t_core;       ///< thickness of the rib/core layer
+		double t_slab;       ///< thickness of the slab layer, strip only
+		double width;        ///< width of the rib/core
+		double gap;          ///< width of the slot, slot only
+		double n_box;        ///< refractive index of the box
+		double n_core;       ///< refractive index of the core
+		double n_clad;       ///< refractive index of the cladding
+		double n_slot;       ///< refractive index of the slot, slot only
+	};
+	static_assert(sizeof(request) == 80);
+
+	/**
+	 * \brief Status of a response
+	 */
+	enum Reply:uint8_t
+	{
+		SOLVED,  ///< neff holds the effective refractive index
+		INVALID, ///< the request is not a valid waveguide
+		FAILED   ///< the solver raised an error
+	};
+
+	/**
+	 * \brief The answer to a request
+	 */
+	struct response
+	{
+		uint32_t id;      ///< identifier of the request
+		uint8_t status;   ///< Reply
+		uint8_t pad[3];   ///< reserved, 0
+		double neff;      ///< effective refractive index
+	};
+	static_assert(sizeof(response) == 16);
+
+	/**
+	 * \brief Solve a request
+	 * \returns the response, the vertical stage is answered from the vertical cache
+	 */
+	inline response
+	answer(const request& q)
+	{
+		response r{q.id, SOLVED, {0, 0, 0}, 0};
+
+		bool valid = (q.device == STRIP || q.device == SLOT) && (q.mode == TE || q.mode == TM) &&
+			q.wavelength > 0 && q.t_core > 0 && q.t_slab >= 0 && q.width > 0 &&
+			q.n_box > 0 && q.n_core > 0 && q.n_clad > 0 &&
+			(q.device == STRIP || (q.gap > 0 && q.n_slot > 0));
+		if (!valid)
+		{
+			r.status = INVALID;
+			return r;
+		}
+
+		try
+		{
+			if (q.device == STRIP)
+			{
+				Strip wg{q.wavelength, q.t_core, q.t_slab, q.width, 0, q.n_box, q.n_core, q.n_clad,
+					q.mode_order, Mode(q.mode)};
+				r.neff = wg();
+			}
+			else
+			{
+				waveguide wg{q.wavelength, q.t_core, q.width, q.gap, q.n_box, q.n_clad, q.n_core, q.n_slot,
+					q.mode_order, Mode(q.mode)};
+				r.neff = wg();
+			}
+		}
+		catch(const std::exception&)
+		{
+			r.status = FAILED;
+		}
+		return r;
+	}
+
+	/**
+	 * \brief Batches the requests of concurrent streams onto the parallel engine.
+	 *
+	 * Streams submit the requests they have read and wait for their responses. A single dispatcher
+	 * takes every pending submission at once and solves them together, so that a
+	 * burst of requests over many connections is one parallel batch.
+	 */
+	class batcher
+	{
+		struct submission
+		{
+			const request* q;  ///< requests of the submission
+			response* r;       ///< responses of the submission
+			size_t n;          ///< number of requests
+			bool done = false; ///< set once the responses are written
+		};
+
+		std::mutex lock;
+		std::condition_variable pending;
+		std::condition_variable served;
+		std::deque<submission*> queue;
+		bool stopping = false;
+		std::thread dispatcher;
+
+		void
+		dispatch()
+		{
+			std::vector<submission*> batch;
+			std::vector<std::pair<const request*, response*>> work;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> l(lock);
+					pending.wait(l, [this]() { return stopping || !queue.empty(); });
+					if (queue.empty())
+						return;
+					batch.assign(queue.begin(), queue.end());
+					queue.clear();
+				}
+
+				work.clear();
+				for (auto* s : batch)
+					for (size_t i = 0; i < s->n; i++)
+						work.emplace_back(s->q + i, s->r + i);
+
+				auto solve = [](std::pair<const request*, response*>& w) { *w.second = answer(*w.first); };
+
+				#if PARALLEL
+				// A single request is not worth the thread pool
+				if (work.size() > 1)
+					std::for_each(std::execution::par, work.begin(), work.end(), solve);
+				else
+				#endif
+					std::for_each(work.begin(), work.end(), solve);
+
+				{
+					std::lock_guard<std::mutex> l(lock);
+					for (auto* s : batch)
+						s->done = true;
+				}
+				served.notify_all();
+			}
+		}
+
+		public:
+		batcher():
+		dispatcher([this]() { dispatch(); })
+		{ }
+
+		~batcher()
+		{
+			{
+				std::lock_guard<std::mutex> l(lock);
+				stopping = true;
+			}
+			pending.notify_all();
+			dispatcher.join();
+		}
+
+		batcher(const batcher&) = delete;
+		batcher& operator=(const batcher&) = delete;
+
+		/**
+		 * \brief solve n requests, blocking until their responses are written
+		 **/
+		void
+		operator()(const request* q, response* r, size_t n)
+		{
+			submission s{q, r, n};
+			std::unique_lock<std::mutex> l(lock);
+			queue.push_back(&s);
+			pending.notify_one();
+			served.wait(l, [&s]() { return s.done; });
+		}
+	};
+
+	/**
+	 * \brief write all of n bytes
+	 * A socket is written with MSG_NOSIGNAL, so that a client that hangs up is a closed stream
+	 * rather than a SIGPIPE of the server.
+	 * \returns false if the stream is closed
+	 */
+	inline bool
+	write_all(int fd, const void* data, size_t n)
+	{
+		auto p = static_cast<const char*>(data);
+		while (n)
+		{
+			ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+			if (k < 0 && errno == ENOTSOCK)
+				k = ::write(fd, p, n);
+			if (k < 0 && errno == EINTR)
+				continue;
+			if (k <= 0)
+				return false;
+			p += k;
+			n -= k;
+		}
+		return true;
+	}
+
+	/**
+	 * \brief Serve the requests of a stream until it is closed
+	 *
+	 * Every read takes all the whole requests that are available, up to a buffer of requests,
+	 * and they are solved as one submission. A partial request is kept for the next read.
+	 *
+	 * \param in the descriptor of the requests
+	 * \param out the descriptor of the responses
+	 * \param solve the batcher of the server
+	 */
+	inline void
+	serve_stream(int in, int out, batcher& solve)
+	{
+		constexpr size_t capacity = 4096; // requests per read
+		std::vector<request> q(capacity);
+		std::vector<response> r(capacity);
+		auto buf = reinterpret_cast<char*>(q.data());
+		size_t have = 0;
+
+		for (;;)
+		{
+			ssize_t k = ::read(in, buf + have, capacity * sizeof(request) - have);
+			if (k < 0 && errno == EINTR)
+				continue;
+			if (k <= 0)
+				return;
+			have += k;
+
+			size_t n = have / sizeof(request);
+			if (!n)
+				continue;
+
+			solve(q.data(), r.data(), n);
+			if (!write_all(out, r.data(), n * sizeof(response)))
+				return;
+
+			// Keep the partial request at the front of the buffer
+			size_t rest = have - n * sizeof(request);
+			std::memmove(buf, buf + n * sizeof(request), rest);
+			have = rest;
+		}
+	}
+
+	/**
+	 * \brief Serve the connections of a Unix socket, each on its own thread, until the process ends
+	 * \param path the path of the socket, replaced if it is a socket no server listens on
+	 * \param solve the batcher of the server
+	 * \throws std::runtime_error if the path is a file other than a socket, a socket that is already being served,
+	 * or the socket cannot be bound
+	 */
+	[[noreturn]] inline void
+	serve_socket(const std::string& path, batcher& solve)
+	{
+		sockaddr_un addr{};
+		addr.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(addr.sun_path))
+			throw std::runtime_error("serve: socket path too long: " + path);
+		std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			throw std::runtime_error("serve: socket: " + std::string(std::strerror(errno)));
+
+		// A stale socket, that no server listens on any more, is replaced; a live socket or any other file is kept
+		struct stat st;
+		if (::lstat(path.c_str(), &st) == 0)
+		{
+			if (!S_ISSOCK(st.st_mode))
+			{
+				::close(fd);
+				throw std::runtime_error("serve: " + path + " exists and is not a socket");
+			}
+			int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			if (probe < 0)
+			{
+				int err = errno;
+				::close(fd);
+				throw std::runtime_error("serve: socket: " + std::string(std::strerror(err)));
+			}
+			int live = ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 || errno != ECONNREFUSED;
+			::close(probe);
+			if (live)
+			{
+				::close(fd);
+				throw std::runtime_error("serve: " + path + " is already being served");
+			}
+			::unlink(path.c_str());
+		}
+		if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 64) < 0)
+		{
+			int err = errno;
+			::close(fd);
+			throw std::runtime_error("serve: " + path + ": " + std::strerror(err));
+		}
+
+		for (;;)
+		{
+			int client = ::accept(fd, NULL, NULL);
+			if (client < 0)
+				continue;
+			std::thread([client, &solve]()
+			{
+				serve_stream(client, client, solve);
+				::close(client);
+			}).detach();
+		}
+	}
+
+}//namespace eim
+
+#endif //__SERVE_H__
@@ -0,0 +1,234 @@
+#ifndef __SHARD_H__
+#define __SHARD_H__
+/**
+ * \brief Partitioned sweeps.
+ * \file shard.h Shards of a Sweep across Nodes, and their Merge
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <eim.h>
+#include <sweep.h>
+
+namespace eim
+{
+	/**
+	 * \brief Header of a shard file.
+	 * The header is followed by the records of the points of the shard, in the order of their flat index.
+	 * The fields other than index, first and points describe the whole sweep, and are equal across its shards.
+	 */
+	struct shard_header
+	{
+		char magic[8] = {'E', 'I', 'M', 'S', 'H', 'R', 'D', '\0'}; ///< file identifier
+		uint32_t version = 2;       ///< format version
+		uint32_t device = STRIP;    ///< Waveguide, STRIP or SLOT
+		uint64_t index = 0;         ///< the shard, in [0, count)
+		uint64_t count = 1;         ///< number of shards of the sweep
+		uint64_t total = 0;         ///< number of points of the sweep
+		uint64_t first = 0;         ///< flat index of the first point of the shard
+		uint64_t points = 0;        ///< number of points of the shard
+		uint64_t digest = 0;        ///< sweep_digest of the axes of the sweep
+		double t_slab = 0;          ///< thickness of the slab layer, strip only
+		double t_core = 0;          ///< thickness of the rib/core layer
+		double n_box = 0;           ///< refractive index of the substrate
+		double n_core = 0;          ///< refractive index of the core
+		double n_clad = 0;          ///< refractive index of the cladding
+		double n_slot = 0;          ///< refractive index of the slot, slot only
+		uint32_t mode = TE;         ///< Mode, TE or TM
+		uint8_t width_digits = 3;      ///< significant digits of the widths in the neff table
+		uint8_t wavelength_digits = 4; ///< significant digits of the wavelengths in the neff table
+		uint8_t reserved[10] = {};  ///< pads the header to 128 bytes
+	};
+	static_assert(sizeof(shard_header) == 128);
+
+	/**
+	 * \brief Digest of the axes of a sweep, combining the bit patterns of the values of each axis and its size
+	 * The shards of one sweep have one digest, so that shards of sweeps that only share the stack are not merged.
+	 */
+	inline uint64_t
+	sweep_digest(const sweep& s)
+	{
+		uint64_t h = 0xcbf29ce484222325ull;
+		auto mix = [&h](uint64_t v)
+		{
+			h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		};
+		auto axis = [&mix](const auto& values)
+		{
+			mix(values.size());
+			for (auto v : values)
+			{
+				if constexpr (std::is_same_v<std::decay_t<decltype(v)>, double>)
+					mix(std::bit_cast<uint64_t>(v));
+				else
+					mix(v);
+			}
+		};
+		axis(s.wavelengths);
+		axis(s.gaps);
+		axis(s.widths);
+		axis(s.mode_orders);
+		return h;
+	}
+
+	/**
+	 * \brief A solved point of a shard
+	 */
+	struct shard_record
+	{
+		double wavelength;   ///< wavelength
+		double gap;          ///< slot width, 0 for a strip
+		double width;        ///< rib/core width
+		double neff;         ///< effective refractive index
+		uint32_t mode_order; ///< mode order
+		uint32_t pad = 0;    ///< reserved, 0
+	};
+	static_assert(sizeof(shard_record) == 40);
+
+	/**
+	 * \brief the flat indices [first, last) of shard index of count, of a sweep of total points
+	 * The shards are contiguous blocks of the sweep, which differ in size by at most one point,
+	 * so that each node keeps the locality of the width axis.
+	 */
+	inline std::pair<size_t, size_t>
+	shard_range(size_t total, size_t index, size_t count)
+	{
+		return {total * index / count, total * (index + 1) / count};
+	}
+
+	/**
+	 * \brief The points of one shard of a sweep
+	 */
+	struct shard_file
+	{
+		shard_header h;                    ///< the shard header
+		std::vector<shard_record> records; ///< the points of the shard, h.points of them
+
+		/**
+		 * \brief write the shard to a stream, e.g. stdout of a node
+		 * \throws std::runtime_error if the stream cannot be written
+		 */
+		void
+		save(FILE* fp) const
+		{
+			bool ok = std::fwrite(&h, sizeof(h), 1, fp) == 1 &&
+				std::fwrite(records.data(), sizeof(shard_record), records.size(), fp) == records.size();
+			ok &= (std::fflush(fp) == 0);
+			if (!ok)
+				throw std::runtime_error("could not write the shard");
+		}
+
+		/**
+		 * \brief read a shard from a file
+		 * \throws std::runtime_error if the file is not a shard
+		 */
+		static shard_file
+		load(const std::string& path)
+		{
+			FILE* fp = std::fopen(path.c_str(), "rb");
+			if (!fp)
+				throw std::runtime_error("could not open " + path);
+
+			shard_file s;
+			const shard_header reference;
+			bool ok = std::fread(&s.h, sizeof(s.h), 1, fp) == 1 &&
+				std::memcmp(s.h.magic, reference.magic, sizeof(reference.magic)) == 0 &&
+				s.h.version == reference.version &&
+				s.h.index < s.h.count && s.h.first + s.h.points <= s.h.total;
+			if (ok)
+			{
+				s.records.resize(s.h.points);
+				ok = std::fread(s.records.data(), sizeof(shard_record), s.records.size(), fp) == s.records.size();
+			}
+			std::fclose(fp);
+			if (!ok)
+				throw std::runtime_error(path + " is not a shard");
+			return s;
+		}
+	};
+
+	/**
+	 * \brief Stitch the shards of a sweep, in any order, into the points of the sweep in the order of their flat index
+	 * \param paths the shard files
+	 * \param h the header of the sweep, with index 0 and first 0 over all of its points
+	 * \returns the points of the sweep
+	 * \throws std::runtime_error if the shards are of different sweeps, or do not cover the sweep exactly once
+	 */
+	inline std::vector<shard_record>
+	merge_shards(const std::vector<std::string>& paths, shard_header& h)
+	{
+		if (paths.empty())
+			throw std::runtime_error("merge: no shards");
+
+		std::vector<shard_file> shards;
+		for (const auto& path : paths)
+			shards.push_back(shard_file::load(path));
+
+		// Every field but the place of the shard is of the sweep
+		auto sweep_of = [](shard_header s)
+		{
+			s.index = s.first = s.points = 0;
+			return s;
+		};
+		h = sweep_of(shards[0].h);
+		for (size_t k = 1; k < shards.size(); k++)
+		{
+			shard_header other = sweep_of(shards[k].h);
+			if (std::memcmp(&h, &other, sizeof(h)) != 0)
+				throw std::runtime_error("merge: " + paths[k] + " is a shard of another sweep than " + paths[0]);
+		}
+
+		std::vector<size_t> order(shards.size());
+		for (size_t k = 0; k < order.size(); k++)
+			order[k] = k;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return shards[a].h.first < shards[b].h.first; });
+
+		std::vector<shard_record> records;
+		records.reserve(h.total);
+		for (size_t k : order)
+		{
+			const auto& s = shards[k];
+			if (s.h.first != records.size())
+				throw std::runtime_error("merge: " + paths[k] + (s.h.first < records.size() ? " overlaps the points before it" :
+					" follows missing points " + std::to_string(records.size()) + " to " + std::to_string(s.h.first - 1)));
+			records.insert(records.end(), s.records.begin(), s.records.end());
+		}
+		if (records.size() != h.total)
+			throw std::runtime_error("merge: missing points " + std::to_string(records.size()) + " to " + std::to_string(h.total - 1));
+
+		h.points = h.total;
+		return records;
+	}
+
+}//namespace eim
+
+#endif //__SHARD_H__
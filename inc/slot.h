@@ -33,6 +33,16 @@
 
 namespace eim
 {
+	/**
+	 * \brief Parities of the lateral supermodes of the slot slab, as flags
+	 */
+	enum Parity:uint8_t
+	{
+		EVEN_MODE = 1, ///< cosh-type mode of slot_cosh_equation, the mode of the slot waveguide
+		ODD_MODE = 2,  ///< sinh-type mode of slot_sinh_equation
+		BOTH_MODES = 3
+	};
+
 	/**
 	 * \brief Five-layer slot waveguide characteristic equation (cosh-type even mode)
 	 * This is for the case n_core > n_clad >= n_slot
@@ -45,23 +55,25 @@ namespace eim
 	 * \param b half-width of slot + core thickness
 	 * \param j mode order
 	 * \param neff effective refractive index
+	 * \tparam T double, or ad::jet2 to differentiate along a parameter of the slab
 	 * \returns difference between LHS and RHS of characteristic equation
 	 */ 
-	double slot_cosh_equation(double n_clad, double n_core, double n_slot, 
-							  double lambda, double a, double b, int j, double neff)
+	template<typename T = double>
+	T slot_cosh_equation(T n_clad, T n_core, T n_slot, 
+							  T lambda, double a, double b, int j, T neff)
 	{
-		double k0 = 2*pi / lambda; 
+		T k0 = 2*pi / lambda; 
 		
 		// For neff between n_clad and n_core
-		double gamma_slot = k0*sqrt(neff*neff - n_slot*n_slot);
-		double kappa_core = k0*sqrt(n_core*n_core - neff*neff);
-		double gamma_clad = k0*sqrt(neff*neff - n_clad*n_clad);
+		T gamma_slot = k0*sqrt((neff - n_slot)*(neff + n_slot));
+		T kappa_core = k0*sqrt((n_core - neff)*(n_core + neff));
+		T gamma_clad = k0*sqrt((neff - n_clad)*(neff + n_clad));
 		
-		double term1 = atan2(n_core*n_core * gamma_clad, n_clad*n_clad * kappa_core);
-		double term2 = atan2(n_core*n_core * gamma_slot * tanh(gamma_slot * a), 
+		T term1 = atan2(n_core*n_core * gamma_clad, n_clad*n_clad * kappa_core);
+		T term2 = atan2(n_core*n_core * gamma_slot * tanh(gamma_slot * a), 
 							n_slot*n_slot * kappa_core);
-		double lhs = term1 + term2 + (j)*pi;
-		double rhs = kappa_core * (b - a);
+		T lhs = term1 + term2 + (j)*pi;
+		T rhs = kappa_core * (b - a);
 		
 		return rhs - lhs;
 	}
@@ -69,29 +81,32 @@ namespace eim
 	/**
 	 * \brief Five-layer slot waveguide characteristic equation (sinh-type odd mode)
 	 */ 
-	double slot_sinh_equation(double n_clad, double n_core, double n_slot, 
-							 double lambda, double a, double b, int j, double neff)
+	template<typename T = double>
+	T slot_sinh_equation(T n_clad, T n_core, T n_slot, 
+							 T lambda, double a, double b, int j, T neff)
 	{
-		double k0 = 2*pi / lambda; 
+		T k0 = 2*pi / lambda; 
 		
-		double gamma_slot = k0*sqrt(neff*neff - n_slot*n_slot);
-		double kappa_core = k0*sqrt(n_core*n_core - neff*neff);
-		double gamma_clad = k0*sqrt(neff*neff - n_clad*n_clad);
+		T gamma_slot = k0*sqrt((neff - n_slot)*(neff + n_slot));
+		T kappa_core = k0*sqrt((n_core - neff)*(n_core + neff));
+		T gamma_clad = k0*sqrt((neff - n_clad)*(neff + n_clad));
 		
-		// coth(x) = 1/tanh(x)
-		double coth_term = 1.0 / tanh(gamma_slot * a);
+		// coth(x) = 1/tanh(x), and gamma_slot coth(gamma_slot a) tends to 1/a where the slot field flattens, at neff = n_slot
+		T slot_term = (T(0) < gamma_slot) ? gamma_slot / tanh(gamma_slot * a) : T(1.0 / a);
 		
-		double term1 = atan2(n_core*n_core * gamma_clad, n_clad*n_clad * kappa_core);
-		double term2 = atan2(n_core*n_core * gamma_slot * coth_term, 
+		T term1 = atan2(n_core*n_core * gamma_clad, n_clad*n_clad * kappa_core);
+		T term2 = atan2(n_core*n_core * slot_term, 
 							n_slot*n_slot * kappa_core);
-		double lhs = term1 + term2 + (j)*pi;
-		double rhs = kappa_core * (b - a);
+		T lhs = term1 + term2 + (j)*pi;
+		T rhs = kappa_core * (b - a);
 		
 		return rhs - lhs;
 	}
 
 	/**
-	 * \brief Solve 5-layer symmetric slot waveguide for both even and odd modes
+	 * \brief Solve 5-layer symmetric slot waveguide for its even and odd modes
+	 * 
+	 * Only the parities that are requested are solved, the even mode by default.
 	 * 
 	 * \param n_clad cladding refractive index
 	 * \param n_core core refractive index  
@@ -100,11 +115,15 @@ namespace eim
 	 * \param w_slot slot width (= 2*a)
 	 * \param w_core core thickness (= b - a)
 	 * \param j mode order
-	 * \returns tuple of (neff_cosh, neff_sinh) for even and odd modes
+	 * \param seed optional bracket of the even mode, used before the full bracket
+	 * \param parity the Parity flags of the modes to solve
+	 * \returns tuple of (neff_cosh, neff_sinh) for even and odd modes, max(n_clad, n_slot) for a mode that is not guided
+	 * and NaN for a parity that is not requested
 	 */ 
 	std::tuple<double, double> 
 	solve_slot_slab(double n_clad, double n_core, double n_slot, 
-					double lambda, double w_slot, double w_core, int j)
+					double lambda, double w_slot, double w_core, int j,
+					const std::optional<opt::bracket>& seed = std::nullopt, uint8_t parity = EVEN_MODE)
 	{
 		double a = w_slot / 2.0;
 		double b = a + w_core;
@@ -117,19 +136,220 @@ namespace eim
 			return slot_sinh_equation(n_clad, n_core, n_slot, lambda, a, b, j, neff);  
 		};
 
-		opt::Status s_cosh, s_sinh;
 		auto nmin = std::max(n_clad, n_slot);  // Mode must be guided
+		constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+		double n_cosh = nan, n_sinh = nan;
 		
 		// Solve for cosh-type (even) mode
-		auto n_cosh = opt::bisection(cosh_func, nmin, n_core, s_cosh);
+		if (parity & EVEN_MODE)
+		{
+			opt::Status s_cosh;
+			s_cosh.status = opt::INVALID_RANGE;
+			if (seed && std::max(seed->lo, nmin) < std::min(seed->hi, n_core))
+			{
+				n_cosh = opt::brent(cosh_func, std::max(seed->lo, nmin), std::min(seed->hi, n_core), s_cosh, tol);
+				stats::record(s_cosh);
+			}
+			if (s_cosh.status != opt::CONVERGED)
+			{
+				n_cosh = opt::brent(cosh_func, nmin, n_core, s_cosh, tol);
+				stats::record(s_cosh);
+			}
+			if (s_cosh.status != opt::CONVERGED)
+			{
+				stats::fallback();
+				n_cosh = nmin;
+			}
+		}
 		
 		// Solve for sinh-type (odd) mode
-		auto n_sinh = opt::bisection(sinh_func, nmin, n_core, s_sinh);
+		if (parity & ODD_MODE)
+		{
+			opt::Status s_sinh;
+			n_sinh = opt::brent(sinh_func, nmin, n_core, s_sinh, tol);
+			stats::record(s_sinh);
+			if (s_sinh.status != opt::CONVERGED)
+			{
+				stats::fallback();
+				n_sinh = nmin;
+			}
+		}
+
+		return std::make_tuple(n_cosh, n_sinh);
+	}
+
+	/**
+	 * \brief Constants of the lateral profile of the even mode of the 5-layer slot slab, in the coordinates of slot_mode_1D
+	 * The profile is cosh(gamma_slot x) in the slot, C_core cos(kappa_core (|x| - a) - phi) in the rails
+	 * and C_clad exp(-gamma_clad (|x| - b)) in the cladding.
+	 */
+	struct slot_profile
+	{
+		double a;          ///< half-width of the slot
+		double b;          ///< half-width of the slot and a rail
+		double gamma_slot; ///< decay constant of the slot
+		double kappa_core; ///< transverse wavenumber of the rails
+		double gamma_clad; ///< decay constant of the cladding
+		double phi;        ///< phase of the rails at |x| = a
+		double C_core;     ///< amplitude of the rails
+		double C_clad;     ///< amplitude of the cladding
+	};
 
-		return std::make_tuple(
-			(s_cosh.status == opt::CONVERGED) ? n_cosh : nmin,
-			(s_sinh.status == opt::CONVERGED) ? n_sinh : nmin
+	/**
+	 * \brief calculate the constants of the lateral profile of the even slot mode, with unit amplitude in the slot
+	 * \see slot_mode_1D
+	 */
+	inline slot_profile
+	slot_coefficients(double neff, double n_clad, double n_core, double n_slot, double lambda, double w_slot, double w_core)
+	{
+		double a = w_slot / 2.0;
+		double b = a + w_core;
+
+		double k0 = 2*pi / lambda;
+		double gamma_slot = k0*sqrt((neff - n_slot)*(neff + n_slot));
+		double kappa_core = k0*sqrt((n_core - neff)*(n_core + neff));
+		double gamma_clad = k0*sqrt((neff - n_clad)*(neff + n_clad));
+
+		// Applying the Boundary Conditions at |x| = a to cosh(gamma_slot x) in the slot, and
+		// C_core cos(kappa_core (|x| - a) - phi) in the rails:
+		//			C_core cos(phi) = cosh(gamma_slot a)
+		//			kappa_core/n_core^2 C_core sin(phi) = gamma_slot/n_slot^2 sinh(gamma_slot a)
+		// At |x| = b the cladding is C_clad exp(-gamma_clad (|x| - b)), with
+		//			C_clad = C_core cos(kappa_core (b - a) - phi)
+		// and the condition on the derivative at |x| = b is the characteristic equation
+		double phi = atan2(n_core*n_core * gamma_slot * tanh(gamma_slot * a), n_slot*n_slot * kappa_core);
+		double C_core = cosh(gamma_slot * a) / cos(phi);
+		double C_clad = C_core * cos(kappa_core * (b - a) - phi);
+
+		return {a, b, gamma_slot, kappa_core, gamma_clad, phi, C_core, C_clad};
+	}
+
+	/**
+	 * \brief Integrals of the intensity of the lateral profile of the even slot mode by region, in closed form
+	 * \returns $\int |A|^2 dx$ over the cladding, rail, slot, rail and cladding, of the profile of slot_mode_1D
+	 */
+	inline std::array<double, 5>
+	slot_power(double neff, double n_clad, double n_core, double n_slot, double lambda, double w_slot, double w_core)
+	{
+		const auto [a, b, gamma_slot, kappa_core, gamma_clad, phi, C_core, C_clad] =
+			slot_coefficients(neff, n_clad, n_core, n_slot, lambda, w_slot, w_core);
+
+		// $\int_b^\inf C_{clad}^2 e^{-2\gamma_{clad} (x - b)} dx$
+		double clad = C_clad * C_clad / (2.0 * gamma_clad);
+		// $\int_0^{b-a} C_{core}^2 cos^2(\kappa_{core} u - \phi) du$
+		double rail = C_core * C_core * ((b - a) / 2.0 +
+			(sin(2 * kappa_core * (b - a) - 2 * phi) + sin(2 * phi)) / (4.0 * kappa_core));
+		// $\int_{-a}^a cosh^2(\gamma_{slot} x) dx$
+		double slot = a + sinh(2 * gamma_slot * a) / (2.0 * gamma_slot);
+
+		return {clad, rail, slot, rail, clad};
+	}
+
+	/**
+	 * \brief Return the lateral profile of the cosh-type (even) mode of the 5-layer slot slab.
+	 *
+	 * The coordinate system is such that x = 0 at the centre of the slot
+	 * y
+	 * ^
+	 * | n_clad | n_core | n_slot | n_core | n_clad
+	 * |--------b--------a---0----a--------b-------> |x|
+	 *
+	 * The profile is the principal field of the horizontal slab with the boundary conditions of
+	 * slot_cosh_equation, i.e. it is continuous with (1/n^2) d/dx continuous:
+	 * cosh in the slot, cos in the rails and exp in the cladding. The positions must be sorted,
+	 * and the regions are evaluated by the kernels of mode_1D.
+	 *
+	 * \tparam T the element type of the profile, e.g. std::complex<float> for exports; the profile is evaluated in double
+	 * \param x the positions along the slab
+	 * \param A the field amplitude of the slab
+	 * \param neff the effective refractive index of the slab, from solve_slot_slab
+	 * \param n_clad cladding refractive index
+	 * \param n_core core refractive index
+	 * \param n_slot slot refractive index
+	 * \param lambda Wavelength in meter
+	 * \param w_slot slot width (= 2*a)
+	 * \param w_core core thickness (= b - a)
+	 * \see exp_region, cos_region
+	 */
+	template <typename I1, typename I2, typename T = field_t>
+	void
+	slot_mode_1D(I1 x1, I2 x2, T* A,
+		double neff, double n_clad, double n_core, double n_slot, double lambda, double w_slot, double w_core)
+	{
+		const size_t xs = std::distance(x1, x2);
+		const auto x = &(*x1);
+
+		const auto [a, b, gamma_slot, kappa_core, gamma_clad, phi, C_core, C_clad] =
+			slot_coefficients(neff, n_clad, n_core, n_slot, lambda, w_slot, w_core);
+
+		// The grid is split into the contiguous sub-ranges of its five regions up front
+		const size_t r1 = std::partition_point(x, x + xs, [&b](double xi) { return xi < -b; }) - x;
+		const size_t r2 = std::partition_point(x + r1, x + xs, [&a](double xi) { return xi < -a; }) - x;
+		const size_t r3 = std::partition_point(x + r2, x + xs, [&a](double xi) { return xi <= a; }) - x;
+		const size_t r4 = std::partition_point(x + r3, x + xs, [&b](double xi) { return xi <= b; }) - x;
+
+		const double h = uniform_step(x, xs);
+		auto set = [&](size_t i, double v) { A[i] = T(v); };
+
+		exp_region(x, 0, r1, h, C_clad, gamma_clad, -b, set);
+		// cos(kappa_core (-x - a) - phi) = cos(kappa_core x + kappa_core a + phi)
+		cos_region(x, r1, r2, h, kappa_core, kappa_core * a + phi, [&](size_t i, double cs, double) { A[i] = T(C_core * cs); });
+		// cosh(gamma_slot x) = (exp(gamma_slot x) + exp(-gamma_slot x)) / 2
+		exp_region(x, r2, r3, h, 0.5, gamma_slot, 0, set);
+		exp_region(x, r2, r3, h, 0.5, -gamma_slot, 0, [&](size_t i, double v) { A[i] += T(v); });
+		cos_region(x, r3, r4, h, kappa_core, -kappa_core * a - phi, [&](size_t i, double cs, double) { A[i] = T(C_core * cs); });
+		exp_region(x, r4, xs, h, C_clad, -gamma_clad, b, set);
+	}
+
+	/**
+	 * \brief calculate the effective refractive index of a slot waveguide, specialized on its mode
+	 * \tparam mode TE or TM mode of the waveguide
+	 * \param m the material stack
+	 * \param seed optional bracket of the effective refractive index of the horizontal stage
+	 * \param parity EVEN_MODE or ODD_MODE
+	 * \returns the effective refractive index of the cosh-type (even) mode, or of the sinh-type (odd) mode
+	 * \see waveguide
+	 */
+	template<Mode mode>
+	double
+	slot_neff(const stack& m, double t_core, double lambda, double w_core, double w_slot, int j,
+		const std::optional<opt::bracket>& seed = std::nullopt, Parity parity = EVEN_MODE)
+	{
+		// The quasi-TE mode corresponds to TM of the horizontal slab, of the TE indices of the vertical slabs,
+		// so only the polarization of mode is solved for the vertical slabs
+
+		//Core refractive index is obtained by 3-layer slabs
+		double neff_core = solve_vertical_mode(mode, m.n_box, m.n_core, m.n_clad, lambda, t_core, 0);
+
+		// Slot refractive index obtained by 3-layer slabs
+		#if 1
+			double neff_slot = solve_vertical_mode(mode, m.n_box, m.n_slot, m.n_clad, lambda, t_core, 0);
+		#endif
+
+		// approximate effective index of slot region with slot index directly
+		// use n_slot if it's < min(n_box, n_clad)
+		#if 0
+			double neff_slot = m.n_slot;
+		#endif
+
+		// Outer cladding regions: box/clad/clad (no core)
+		// Calculate their effective index properly
+		double neff_clad = solve_vertical_mode(mode, m.n_box, m.n_clad, m.n_clad, lambda, t_core, 0);
+
+		// Solve 5-layer slot structure, for the requested parity only
+		stats::timer t(stats::HORIZONTAL);
+		auto neff = solve_slot_slab(
+			neff_clad,						// cladding region
+			neff_core,						// core region
+			neff_slot,						// slot region
+			lambda,
+			w_slot,
+			w_core,
+			j,
+			seed,
+			parity
 		);
+		return (parity == ODD_MODE) ? std::get<1>(neff) : std::get<0>(neff);
 	}
 
 	/**
@@ -168,57 +388,153 @@ namespace eim
 
 		/**
 		 * \brief calculate the effective refractive index
+		 * \param seed optional bracket of the effective refractive index of the horizontal stage
+		 * \param parity EVEN_MODE, the mode of the waveguide, or ODD_MODE
 		 * \returns the effective refractive index 
 		 **/
-		double operator()()
+		double operator()(const std::optional<opt::bracket>& seed = std::nullopt, Parity parity = EVEN_MODE)
 		{
-			//Core refractive index is obtained by 3-layer slabs
-			auto neff_core = solve_slab(n_box, n_core, n_clad, wavelength, t_core, 0);
-			
-			// Slot refractive index obtained by 3-layer slabs
-			#if 1
-				auto ns = solve_slab(n_box, n_slot, n_clad, wavelength, t_core, 0);
-				double neff_slot = (mode == TE) ? std::get<0>(ns) : std::get<1>(ns);
-			#endif
-
-			// approximate effective index of slot region with slot index directly
-			// use n_slot if it's < min(n_box, n_clad)
-			#if 0
-				double neff_slot = n_slot;
-			#endif
-
-			// Outer cladding regions: box/clad/clad (no core)
-			// Calculate their effective index properly
-			auto neff_clad = solve_slab(n_box, n_clad, n_clad, wavelength, t_core, 0);
-
-			
-			// Solve 5-layer slot structure
-			if (mode == TE) // The quasi-TE mode corresponds to TM of the horizontal slab
-			{
-				auto neff = solve_slot_slab(
-					std::get<0>(neff_clad),			// cladding region (TM mode of outer regions)
-					std::get<0>(neff_core),			// core region (TM mode of vertical slab)
-					neff_slot,		         		// slot region 
-					wavelength,
-					w_slot,
-					w_core,
-					mode_order
-				);
-				return std::get<0>(neff);  // Return cosh-type (even) mode
-			}
-			else // The quasi-TM mode corresponds to TE of the horizontal slab
-			{ 
-				auto neff = solve_slot_slab(
-					std::get<1>(neff_clad),			// cladding region (TE mode of outer regions)
-					std::get<1>(neff_core),			// core region (TE mode of vertical slab)
-					neff_slot,						// slot region
-					wavelength, 
-					w_slot, 
-					w_core, 
-					mode_order
-				);
-				return std::get<0>(neff);  // Return cosh-type (even) mode
-			}
+			stack m{n_box, n_core, n_clad, n_slot};
+			if (mode == TE)
+				return slot_neff<TE>(m, t_core, wavelength, w_core, w_slot, mode_order, seed, parity);
+			else
+				return slot_neff<TM>(m, t_core, wavelength, w_core, w_slot, mode_order, seed, parity);
+		}
+
+		/**
+		 * \returns the effective refractive index of the slot or cladding, which a mode that is not guided takes
+		 **/
+		double
+		cladding_index()
+		{
+			return std::max(solve_vertical_mode(mode, n_box, n_clad, n_clad, wavelength, t_core, 0),
+				solve_vertical_mode(mode, n_box, n_slot, n_clad, wavelength, t_core, 0));
+		}
+
+		/**
+		 * \brief differentiate the effective refractive index along the wavelength
+		 * The roots of the vertical slabs and of the cosh-type slot equation are differentiated implicitly,
+		 * for materials without dispersion.
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns neff, dneff/dlambda and d^2neff/dlambda^2
+		 **/
+		ad::jet2
+		dispersion(double neff)
+		{
+			ad::jet2 l(wavelength, 1);
+			auto core = solve_vertical_jet(n_box, n_core, n_clad, l, t_core);
+			auto slot = solve_vertical_jet(n_box, n_slot, n_clad, l, t_core);
+			auto clad = solve_vertical_jet(n_box, n_clad, n_clad, l, t_core);
+
+			// The quasi-TE mode is the TM of the horizontal slab, of the TE indices of the vertical slabs
+			auto neff_core = (mode == TE) ? std::get<0>(core) : std::get<1>(core);
+			auto neff_slot = (mode == TE) ? std::get<0>(slot) : std::get<1>(slot);
+			auto neff_clad = (mode == TE) ? std::get<0>(clad) : std::get<1>(clad);
+
+			if (!(neff > std::max(neff_clad.v, neff_slot.v)))
+				return std::max(neff_clad, neff_slot);
+
+			double a = w_slot / 2.0;
+			double b = a + w_core;
+			return ad::implicit([&](const ad::jet2& n) {
+				return slot_cosh_equation(neff_clad, neff_core, neff_slot, l, a, b, mode_order, n);
+			}, neff);
+		}
+
+		/**
+		 * \brief calculate the power of the mode field by region in closed form, without evaluating the field
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns the power of the lateral profile in the cladding, rail, slot, rail and cladding,
+		 * and of the vertical profile in the box, core and cladding
+		 **/
+		mode_power<5>
+		power(double neff)
+		{
+			double ncore = solve_vertical_mode(mode, n_box, n_core, n_clad, wavelength, t_core, 0);
+			double nslot = solve_vertical_mode(mode, n_box, n_slot, n_clad, wavelength, t_core, 0);
+			double nclad = solve_vertical_mode(mode, n_box, n_clad, n_clad, wavelength, t_core, 0);
+
+			if (mode == TE)
+				return {slot_power(neff, nclad, ncore, nslot, wavelength, w_slot, w_core),
+					slab_power<TE>(ncore, n_box, n_core, n_clad, wavelength, t_core, 0)};
+			else // (mode == TM)
+				return {slot_power(neff, nclad, ncore, nslot, wavelength, w_slot, w_core),
+					slab_power<TM>(ncore, n_box, n_core, n_clad, wavelength, t_core, 0)};
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \param field the field amplitude
+		 **/
+		void
+		mode_2D(cvector<double>& x, cmatrix<field_t>& field)
+		{
+			mode_2D(x, &field[0]);
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude into row storage, e.g. a mapped grid_file record
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \param field the rows of the field amplitude, x.size() rows of x.size() points
+		 **/
+		void
+		mode_2D(cvector<double>& x, field_t** field)
+		{
+			mode_field(x, (*this)(), scratch_field()).materialize(field);
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude as the product of its 1D profiles
+		 * \param x the span of points in x and y to calculate the field amplitude for, x = 0 at the centre of the slot
+		 * \returns the field, with the lateral slot profile along the rows and the vertical core slab profile along the columns
+		 **/
+		separable_field<field_t>
+		mode_field(const cvector<double>& x)
+		{
+			return mode_field(x, (*this)());
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude of a solved effective refractive index
+		 * \param x the span of points in x and y to calculate the field amplitude for, x = 0 at the centre of the slot
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns the field, with the lateral slot profile along the rows and the vertical core slab profile along the columns
+		 **/
+		separable_field<field_t>
+		mode_field(const cvector<double>& x, double neff)
+		{
+			separable_field<field_t> field;
+			mode_field(x, neff, field);
+			return field;
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude of a solved effective refractive index into a field, reusing its storage
+		 * The vertical stage is the one of operator(), which is answered from the vertical cache.
+		 * \param x the span of points in x and y to calculate the field amplitude for, x = 0 at the centre of the slot
+		 * \param neff the effective refractive index, as from operator()
+		 * \param field the field, e.g. the scratch_field of the thread, of complex double or of complex float for exports
+		 * \returns the field
+		 **/
+		template<typename T>
+		separable_field<T>&
+		mode_field(const cvector<double>& x, double neff, separable_field<T>& field)
+		{
+			stats::timer t(stats::FIELD);
+			field.assign(x.begin(), x.end(), x.begin(), x.end());
+
+			double ncore = solve_vertical_mode(mode, n_box, n_core, n_clad, wavelength, t_core, 0);
+			double nslot = solve_vertical_mode(mode, n_box, n_slot, n_clad, wavelength, t_core, 0);
+			double nclad = solve_vertical_mode(mode, n_box, n_clad, n_clad, wavelength, t_core, 0);
+
+			if (mode == TE)
+				mode_1D<TE, TRANSVERSE_FIELD, T>(x.begin(), x.end(), field.v.data(), nullptr, nullptr, ncore, n_box, n_core, n_clad, wavelength, t_core, 0);
+			else // (mode == TM)
+				mode_1D<TM, TRANSVERSE_FIELD, T>(x.begin(), x.end(), field.v.data(), nullptr, nullptr, ncore, n_box, n_core, n_clad, wavelength, t_core, 0);
+			slot_mode_1D(x.begin(), x.end(), field.u.data(), neff, nclad, ncore, nslot, wavelength, w_slot, w_core);
+
+			return field;
 		}
 	};
 
@@ -0,0 +1,258 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+/**
+ * \brief Solver instrumentation.
+ * \file stats.h Thread-safe Solver Counters and Stage Timers
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <libopt.h>
+
+/**
+ * \brief Opt-in instrumentation of the solver.
+ *
+ * Every root finder run is recorded by stage into process wide atomic counters and histograms,
+ * and every stage can be timed. Nothing is recorded until enabled is set, so that the cost
+ * of a disabled probe is one relaxed load.
+ */
+namespace eim::stats
+{
+	/**
+	 * \brief Stages of the effective index method
+	 */
+	enum Stage : uint8_t
+	{
+		VERTICAL,   ///< vertical slab solves
+		HORIZONTAL, ///< horizontal slab solves
+		FIELD,      ///< mode field evaluation
+		OUTPUT,     ///< formatting and writing the results
+		STAGES
+	};
+
+	inline const char* stage_names[STAGES] = {"vertical", "horizontal", "field", "output"};
+
+	/**
+	 * \brief Number of buckets of the iteration histogram.
+	 * Bucket k > 0 counts the runs of [2^(k-1), 2^k) iterations, the last bucket is open ended
+	 */
+	static constexpr size_t buckets = 8;
+
+	/**
+	 * \brief Counters of one stage
+	 */
+	struct counters
+	{
+		std::atomic<uint64_t> calls{0};         ///< timed calls of the stage
+		std::atomic<uint64_t> ns{0};            ///< wall time of the timed calls in nanoseconds
+		std::atomic<uint64_t> solves{0};        ///< root finder runs
+		std::atomic<uint64_t> iterations{0};    ///< iterations of the runs
+		std::atomic<uint64_t> evaluations{0};   ///< function evaluations of the runs
+		std::atomic<uint64_t> diverged{0};      ///< runs that ended DIVERGED
+		std::atomic<uint64_t> invalid_range{0}; ///< runs that ended INVALID_RANGE
+		std::atomic<uint64_t> fallbacks{0};     ///< solves that returned min(n1, n3), since no root converged
+		std::atomic<double> residual{0};        ///< largest residual of a converged run
+		std::atomic<uint64_t> histogram[buckets] = {}; ///< runs by their iterations
+	};
+
+	/**
+	 * \brief Root finder runs of one sweep point, for the per row output
+	 */
+	struct tally
+	{
+		uint32_t solves = 0;        ///< root finder runs
+		uint32_t iterations = 0;    ///< iterations of the runs
+		uint32_t evaluations = 0;   ///< function evaluations of the runs
+		uint32_t diverged = 0;      ///< runs that ended DIVERGED
+		uint32_t invalid_range = 0; ///< runs that ended INVALID_RANGE
+	};
+
+	inline std::atomic<bool> enabled{false}; ///< recording flag
+	inline counters stages[STAGES];          ///< the counters by stage
+	inline thread_local tally* current = nullptr; ///< tally of the point solved by this thread, if any
+	inline thread_local Stage scope = HORIZONTAL;  ///< stage timed by this thread, the stage of its runs
+
+	/**
+	 * \returns true if the instrumentation is recording
+	 */
+	inline bool
+	active()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * \brief record a root finder run
+	 * \param s the statistics of the run
+	 * \param stage the stage of the run, by default the stage timed by the calling thread
+	 */
+	inline void
+	record(const opt::Status& s, Stage stage = scope)
+	{
+		if (!active())
+			return;
+
+		auto& c = stages[stage];
+		const auto relaxed = std::memory_order_relaxed;
+		c.solves.fetch_add(1, relaxed);
+		c.iterations.fetch_add(s.iterations, relaxed);
+		c.evaluations.fetch_add(s.evaluations, relaxed);
+		c.diverged.fetch_add(s.status == opt::DIVERGED, relaxed);
+		c.invalid_range.fetch_add(s.status == opt::INVALID_RANGE, relaxed);
+		c.histogram[std::min<size_t>(std::bit_width(s.iterations), buckets - 1)].fetch_add(1, relaxed);
+
+		if (s.status == opt::CONVERGED)
+		{
+			double r = c.residual.load(relaxed);
+			while (s.residual > r && !c.residual.compare_exchange_weak(r, s.residual, relaxed))
+				;
+		}
+
+		if (current)
+		{
+			current->solves++;
+			current->iterations += s.iterations;
+			current->evaluations += s.evaluations;
+			current->diverged += (s.status == opt::DIVERGED);
+			current->invalid_range += (s.status == opt::INVALID_RANGE);
+		}
+	}
+
+	/**
+	 * \brief record a solve that fell back to min(n1, n3)
+	 */
+	inline void
+	fallback(Stage stage = scope)
+	{
+		if (active())
+			stages[stage].fallbacks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * \brief Scoped timer of a stage
+	 * The runs recorded by the calling thread within the scope are counted to the stage.
+	 */
+	class timer
+	{
+		using clock = std::chrono::steady_clock;
+		Stage stage;
+		Stage outer;
+		bool on;
+		clock::time_point t0;
+
+		public:
+		explicit timer(Stage stage):
+		stage(stage),
+		outer(scope),
+		on(active())
+		{
+			if (!on)
+				return;
+			scope = stage;
+			t0 = clock::now();
+		}
+
+		~timer()
+		{
+			if (!on)
+				return;
+			scope = outer;
+			auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+			stages[stage].calls.fetch_add(1, std::memory_order_relaxed);
+			stages[stage].ns.fetch_add(dt, std::memory_order_relaxed);
+		}
+
+		timer(const timer&) = delete;
+		timer& operator=(const timer&) = delete;
+	};
+
+	/**
+	 * \brief Solve a point, tallying the root finder runs of the calling thread
+	 * \param t the tally of the point
+	 * \param f callable that solves the point
+	 * \returns the result of f
+	 */
+	template<typename F>
+	auto
+	tallied(tally& t, F&& f)
+	{
+		tally* outer = current;
+		current = &t;
+		struct restore { tally* p; ~restore() { current = p; } } r{outer};
+		return f();
+	}
+
+	/**
+	 * \brief write the counters of every stage
+	 * \param out the stream, e.g. stderr
+	 */
+	inline void
+	summary(FILE* out)
+	{
+		const auto relaxed = std::memory_order_relaxed;
+		std::fprintf(out, "[STATS] %-10s %10s %12s %10s %10s %10s %10s %10s %10s %12s\n", "stage", "calls", "time(ms)",
+			"solves", "iter/run", "eval/run", "diverged", "invalid", "fallback", "residual");
+
+		for (size_t k = 0; k < STAGES; k++)
+		{
+			const auto& c = stages[k];
+			uint64_t n = c.solves.load(relaxed);
+			double mean_iter = n ? double(c.iterations.load(relaxed)) / n : 0;
+			double mean_eval = n ? double(c.evaluations.load(relaxed)) / n : 0;
+			std::fprintf(out, "[STATS] %-10s %10llu %12.3f %10llu %10.2f %10.2f %10llu %10llu %10llu %12.3g\n",
+				stage_names[k],
+				(unsigned long long)c.calls.load(relaxed),
+				c.ns.load(relaxed) * 1e-6,
+				(unsigned long long)n, mean_iter, mean_eval,
+				(unsigned long long)c.diverged.load(relaxed),
+				(unsigned long long)c.invalid_range.load(relaxed),
+				(unsigned long long)c.fallbacks.load(relaxed),
+				c.residual.load(relaxed));
+		}
+
+		// Histograms of the stages that ran a root finder
+		for (size_t k = 0; k < STAGES; k++)
+		{
+			const auto& c = stages[k];
+			if (!c.solves.load(relaxed))
+				continue;
+			std::fprintf(out, "[STATS] %-10s iterations", stage_names[k]);
+			for (size_t b = 0; b < buckets; b++)
+			{
+				uint64_t lo = b ? (uint64_t(1) << (b - 1)) : 0;
+				if (b + 1 < buckets)
+					std::fprintf(out, " %llu-%llu:%llu", (unsigned long long)lo,
+						(unsigned long long)(b ? 2 * lo - 1 : 0), (unsigned long long)c.histogram[b].load(relaxed));
+				else
+					std::fprintf(out, " %llu+:%llu", (unsigned long long)lo, (unsigned long long)c.histogram[b].load(relaxed));
+			}
+			std::fprintf(out, "\n");
+		}
+	}
+
+}//namespace eim::stats
+
+#endif //__STATS_H__
@@ -0,0 +1,347 @@
+#ifndef __STORE_H__
+#define __STORE_H__
+/**
+ * \brief Persistent memoization.
+ * \file store.h Memory-mapped Result Cache shared across Runs and Processes
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <eim.h>
+#include <cache.h>
+
+namespace eim
+{
+	/**
+	 * \brief Key of a solved point: the full parameter set with the solver version and tolerance
+	 */
+	struct store_key
+	{
+		uint32_t device;                    ///< Waveguide, STRIP or SLOT
+		uint32_t mode;                      ///< Mode, TE or TM
+		uint32_t mode_order;                ///< mode order
+		uint32_t version = solver_version;  ///< version of the solvers
+		double wavelength;                  ///< wavelength
+		double width;                       ///< rib/core width
+		double gap;                         ///< slot width, 0 for a strip
+		double t_core;                      ///< thickness of the rib/core layer
+		double t_slab;                      ///< thickness of the slab layer, 0 for a slot
+		double n_box;                       ///< refractive index of the substrate
+		double n_core;                      ///< refractive index of the core
+		double n_clad;                      ///< refractive index of the cladding
+		double n_slot;                      ///< refractive index of the slot, 0 for a strip
+		double tol = eim::tol;              ///< tolerance of the root finding
+
+		/**
+		 * \returns the floating point members, in order
+		 **/
+		std::array<double, 10>
+		values() const
+		{
+			return {wavelength, width, gap, t_core, t_slab, n_box, n_core, n_clad, n_slot, tol};
+		}
+
+		bool
+		operator==(const store_key& o) const
+		{
+			auto a = values(), b = o.values();
+			return device == o.device && mode == o.mode && mode_order == o.mode_order && version == o.version &&
+				std::equal(a.begin(), a.end(), b.begin(), [](double x, double y) { return key_bits(x) == key_bits(y); });
+		}
+	};
+	static_assert(sizeof(store_key) == 96);
+
+	/**
+	 * \brief Hash of a store_key, combining the key_bits of its members as slab_key_hash
+	 */
+	inline uint64_t
+	store_hash(const store_key& k)
+	{
+		uint64_t h = 0xcbf29ce484222325ull;
+		auto mix = [&h](uint64_t v)
+		{
+			h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+		};
+		mix((uint64_t(k.device) << 32) | k.mode);
+		mix((uint64_t(k.mode_order) << 32) | k.version);
+		for (double v : k.values())
+			mix(key_bits(v));
+		return h;
+	}
+
+	/**
+	 * \brief A persistent, content addressed cache of effective refractive indices.
+	 *
+	 * The file is an open addressing hash table of store_key to neff, mapped shared, so that the
+	 * workers of a sweep and concurrent processes use one copy. Lookups and inserts are lock-free:
+	 * a slot is claimed by a compare and swap of its state, written, then published with a release
+	 * store, and a lookup reads a slot only once it has acquired its published state. Concurrent
+	 * inserts of one key may both store it; the first found is returned.
+	 *
+	 * The table only grows when it is opened, under an exclusive file lock, by rehashing into a
+	 * new file which replaces the old one. A process that still maps the old file keeps reading it,
+	 * and its inserts from then on are lost, which a cache can afford.
+	 */
+	class neff_store
+	{
+		public:
+		/**
+		 * \brief Header of a store file, followed by the slots of the table
+		 */
+		struct header
+		{
+			char magic[8] = {'E', 'I', 'M', 'S', 'T', 'O', 'R', 'E'}; ///< file identifier
+			uint32_t version = 1;   ///< format version
+			uint32_t pad = 0;       ///< reserved, 0
+			uint64_t capacity = 0;  ///< number of slots, a power of 2
+			uint64_t count = 0;     ///< number of stored points, updated atomically
+			uint8_t reserved[32] = {}; ///< pads the header to 64 bytes
+		};
+		static_assert(sizeof(header) == 64);
+
+		/**
+		 * \brief A slot of the table
+		 */
+		struct slot
+		{
+			uint64_t state; ///< EMPTY, CLAIMED while it is written, or READY
+			uint64_t hash;  ///< hash of the key
+			store_key key;  ///< the key
+			double neff;    ///< the value
+			double pad;     ///< pads the slot to 128 bytes
+		};
+		static_assert(sizeof(slot) == 128);
+		static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+
+		enum : uint64_t { EMPTY = 0, CLAIMED = 1, READY = 2 };
+
+		/**
+		 * \brief open or create a store, with room for reserve more points
+		 * \param path the file name
+		 * \param reserve the number of points that may be inserted, e.g. the size of a sweep
+		 * \throws std::runtime_error if the file cannot be opened or is not a store
+		 */
+		neff_store(const std::string& path, size_t reserve = 0)
+		{
+			// The file is locked to be created or grown, and opened again if another process has replaced it meanwhile
+			struct stat st, now;
+			for (;;)
+			{
+				fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+				if (fd_ < 0)
+					throw std::runtime_error("could not open " + path);
+				::flock(fd_, LOCK_EX);
+				if (::fstat(fd_, &st) != 0)
+					fail("could not stat " + path);
+				if (::stat(path.c_str(), &now) == 0 && now.st_ino == st.st_ino && now.st_dev == st.st_dev)
+					break;
+				::close(fd_);
+			}
+
+			if (st.st_size == 0)
+				create(path, capacity_for(reserve));
+			map(path);
+
+			// Keep the load factor at most 1/2, once the reserved points are in
+			if (2 * (count() + reserve) > h_->capacity)
+			{
+				std::string tmp = path + ".tmp";
+				neff_store next(tmp, capacity_for(count() + reserve), fresh{});
+				for (size_t i = 0; i < h_->capacity; i++)
+					if (slots_[i].state == READY)
+						next.insert(slots_[i].key, slots_[i].neff);
+				if (::rename(tmp.c_str(), path.c_str()) != 0)
+					fail("could not replace " + path);
+
+				// Closing the old file releases its lock, to the processes that will find it replaced
+				unmap();
+				::close(fd_);
+				std::swap(fd_, next.fd_);
+				std::swap(h_, next.h_);
+				std::swap(slots_, next.slots_);
+				std::swap(size_, next.size_);
+				next.fd_ = -1;
+			}
+			else
+				::flock(fd_, LOCK_UN);
+		}
+
+		neff_store(const neff_store&) = delete;
+		neff_store& operator=(const neff_store&) = delete;
+
+		~neff_store()
+		{
+			unmap();
+			if (fd_ >= 0)
+				::close(fd_);
+		}
+
+		/**
+		 * \returns the stored neff of key, or nothing
+		 */
+		std::optional<double>
+		find(const store_key& key) const
+		{
+			const uint64_t h = store_hash(key);
+			const size_t mask = h_->capacity - 1;
+			for (size_t n = 0, i = h & mask; n < h_->capacity; n++, i = (i + 1) & mask)
+			{
+				const slot& s = slots_[i];
+				uint64_t state = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(s.state)).load(std::memory_order_acquire);
+				if (state == EMPTY)
+					return std::nullopt;
+				if (state == READY && s.hash == h && s.key == key)
+					return s.neff;
+			}
+			return std::nullopt;
+		}
+
+		/**
+		 * \brief store the neff of key
+		 * \returns false if the key is stored already, or the table is full
+		 */
+		bool
+		insert(const store_key& key, double neff)
+		{
+			const uint64_t h = store_hash(key);
+			const size_t mask = h_->capacity - 1;
+			for (size_t n = 0, i = h & mask; n < h_->capacity; n++, i = (i + 1) & mask)
+			{
+				slot& s = slots_[i];
+				std::atomic_ref<uint64_t> state(s.state);
+				uint64_t expected = EMPTY;
+				if (state.compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire))
+				{
+					s.hash = h;
+					s.key = key;
+					s.neff = neff;
+					state.store(READY, std::memory_order_release);
+					std::atomic_ref<uint64_t>(h_->count).fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+				if (expected == READY && s.hash == h && s.key == key)
+					return false;
+			}
+			return false;
+		}
+
+		/**
+		 * \returns the number of stored points
+		 */
+		size_t
+		count() const
+		{
+			return std::atomic_ref<uint64_t>(h_->count).load(std::memory_order_relaxed);
+		}
+
+		private:
+		int fd_{-1};
+		header* h_{nullptr};
+		slot* slots_{nullptr};
+		size_t size_{0};
+
+		struct fresh {};
+
+		/**
+		 * \brief create an empty store of a capacity, replacing the file
+		 */
+		neff_store(const std::string& path, size_t capacity, fresh)
+		{
+			fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (fd_ < 0)
+				throw std::runtime_error("could not open " + path);
+			create(path, capacity);
+			map(path);
+		}
+
+		static size_t
+		capacity_for(size_t points)
+		{
+			return std::bit_ceil(std::max<size_t>(1024, 2 * points));
+		}
+
+		[[noreturn]] void
+		fail(const std::string& what)
+		{
+			unmap();
+			if (fd_ >= 0)
+				::close(fd_);
+			fd_ = -1;
+			throw std::runtime_error(what);
+		}
+
+		void
+		create(const std::string& path, size_t capacity)
+		{
+			header h;
+			h.capacity = capacity;
+			if (::ftruncate(fd_, sizeof(header) + capacity * sizeof(slot)) != 0 ||
+				::pwrite(fd_, &h, sizeof(h), 0) != sizeof(h))
+				fail("could not size " + path);
+		}
+
+		void
+		map(const std::string& path)
+		{
+			header h;
+			const header reference;
+			struct stat st;
+			if (::pread(fd_, &h, sizeof(h), 0) != sizeof(h) || ::fstat(fd_, &st) != 0 ||
+				std::memcmp(h.magic, reference.magic, sizeof(h.magic)) != 0 || h.version != reference.version ||
+				!std::has_single_bit(h.capacity) || size_t(st.st_size) != sizeof(header) + h.capacity * sizeof(slot))
+				fail(path + " is not a store");
+
+			size_ = st.st_size;
+			void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+			if (p == MAP_FAILED)
+				fail("could not map " + path);
+			h_ = static_cast<header*>(p);
+			slots_ = reinterpret_cast<slot*>(static_cast<std::byte*>(p) + sizeof(header));
+		}
+
+		void
+		unmap()
+		{
+			if (h_)
+				::munmap(h_, size_);
+			h_ = nullptr;
+			slots_ = nullptr;
+		}
+	};
+
+}//namespace eim
+
+#endif //__STORE_H__
@@ -28,6 +28,12 @@
 #include <eim.h>
 #include <libvec.h>
 #include <libopt.h>
+#include <cache.h>
+#include <field.h>
+#include <stats.h>
+#include <jet.h>
+#include <array>
+#include <optional>
 
 namespace eim
 {
@@ -42,92 +48,493 @@ namespace eim
 	 * \param W extent of core; slab thickness
 	 * \param j the mode order to solve 
 	 * \param neff the effective refractive index
+	 * \tparam T double, or ad::jet2 to differentiate along a parameter of the slab
 	 * \returns the difference between the left and right hand sides of the characteristic equations.
 	 */ 
-	template<Mode mode>
-	double slab_equation(double n1, double n2, double n3, double lambda, double W, int j, double neff)
+	template<Mode mode, typename T = double>
+	T slab_equation(T n1, T n2, T n3, T lambda, double W, int j, T neff)
 	{
-		double k0 = 2*pi*(1 / lambda); 
-		double gamma1 = k0*sqrt( pow(neff, 2) - pow(n1, 2) );
-		double gamma2 = k0*sqrt( pow(n2, 2) - pow(neff, 2) );
-		double gamma3 = k0*sqrt( pow(neff, 2) - pow(n3, 2) );
+		T k0 = 2*pi*(1 / lambda); 
+		T gamma1 = k0*sqrt( (neff - n1) * (neff + n1) );
+		T gamma2 = k0*sqrt( (n2 - neff) * (n2 + neff) );
+		T gamma3 = k0*sqrt( (neff - n3) * (neff + n3) );
 
-		double lhs = gamma2 * W;
+		T lhs = gamma2 * W;
 		if constexpr (mode == TE)
 		{
-			double rhs = -atan2(gamma2, gamma1) - atan2(gamma2, gamma3) + (j+1)*pi;
+			T rhs = -atan2(gamma2, gamma1) - atan2(gamma2, gamma3) + (j+1)*pi;
 			return rhs - lhs;
 		}
 		if constexpr (mode == TM)
 		{
-			double rhs = -atan2(pow(n1, 2) * gamma2, pow(n2, 2) * gamma1) - 
+			T rhs = -atan2(pow(n1, 2) * gamma2, pow(n2, 2) * gamma1) - 
 				atan2( pow(n3, 2) * gamma2, pow(n2, 2) * gamma3 ) + (j+1)*pi;
 			return rhs - lhs;
 		}
 	}
 
 	/**
-	 * \brief Calculate the fields of 3 layer slab
+	 * \brief Characteristic equation of the 3 layer slab and its derivative with respect to neff.
+	 * 
+	 * Differentiating each phase term, atan2(p*gamma2, q*gamma_i), with 
+	 * d(gamma_i)/d(neff) = k0^2 neff / gamma_i and d(gamma2)/d(neff) = -k0^2 neff / gamma2 gives
+	 * $\frac{d}{dn} = -\frac{p q k_0^2 n (\gamma_i^2 + \gamma_2^2)}{\gamma_i \gamma_2 (q^2 \gamma_i^2 + p^2 \gamma_2^2)}$
+	 * 
+	 * \see slab_equation
+	 * \returns the pair of slab_equation and its derivative at neff.
+	 * The derivative is not finite at the bounds of the guided range, where a gamma vanishes.
+	 */ 
+	template<Mode mode>
+	std::pair<double, double>
+	slab_equation_fdf(double n1, double n2, double n3, double lambda, double W, int j, double neff)
+	{
+		double k0 = 2*pi*(1 / lambda); 
+		double gamma1 = k0*sqrt( (neff - n1) * (neff + n1) );
+		double gamma2 = k0*sqrt( (n2 - neff) * (n2 + neff) );
+		double gamma3 = k0*sqrt( (neff - n3) * (neff + n3) );
+
+		double p1 = (mode == TE) ? 1.0 : pow(n1, 2);
+		double p3 = (mode == TE) ? 1.0 : pow(n3, 2);
+		double q = (mode == TE) ? 1.0 : pow(n2, 2);
+
+		double f = -atan2(p1 * gamma2, q * gamma1) - atan2(p3 * gamma2, q * gamma3) + (j+1)*pi - gamma2 * W;
+
+		auto dphase = [&](double p, double gamma)
+		{
+			return p * q * pow(k0, 2) * neff * (pow(gamma, 2) + pow(gamma2, 2)) / 
+				(gamma * gamma2 * (pow(q * gamma, 2) + pow(p * gamma2, 2)));
+		};
+		double df = dphase(p1, gamma1) + dphase(p3, gamma3) + W * pow(k0, 2) * neff / gamma2;
+
+		return {f, df};
+	}
+
+	/**
+	 * \brief Solve one polarization of the 3 layer slab
+	 * 
+	 * Guided modes are bracketed by [max(n1, n3), n2] and solved by the safeguarded Newton method
+	 * on the analytic derivative of the characteristic equation.
+	 * A seed narrows the bracket, e.g. around the prediction of a continuation; the full bracket is 
+	 * used instead when the seed does not contain a sign change.
+	 * 
 	 * \param n1 box refractive index
 	 * \param n2 core refractive index  
 	 * \param n3 cladding refractive index  
 	 * \param lambda Wavelength in meter
 	 * \param W extent of core; slab thickness
 	 * \param j the mode order to solve 
-	 * \returns the effective refractive index 
+	 * \param seed optional bracket of the effective refractive index
+	 * \returns the effective refractive index, or min(n1, n3) if the mode is not guided
 	 */ 
-	std::tuple<double, double> 
-	solve_slab(double n1, double n2, double n3, double lambda, double W, int j)
+	template<Mode mode>
+	double
+	solve_slab_mode(double n1, double n2, double n3, double lambda, double W, int j,
+		const std::optional<opt::bracket>& seed = std::nullopt)
 	{
-		auto slab_TE = [&n1, &n2, &n3, &lambda, &W, &j](double neff) {
-			return slab_equation<TE>(n1, n2, n3, lambda, W, j, neff);
+		auto slab = [&n1, &n2, &n3, &lambda, &W, &j](double neff) {
+			return slab_equation_fdf<mode>(n1, n2, n3, lambda, W, j, neff);
 		};
 
-		auto slab_TM = [&n1, &n2, &n3, &lambda, &W, &j](double neff) {
-			return slab_equation<TM>(n1, n2, n3, lambda, W, j, neff);  
-		};
-
-		opt::Status s_TE, s_TM;
 		auto nmin = std::min(n1, n3);
-		auto n_TE = opt::bisection(slab_TE, nmin, n2, s_TE);
-		auto n_TM = opt::bisection(slab_TM, nmin, n2, s_TM);
+		auto nmax = std::max(n1, n3);
+		if (nmax >= n2)
+		{
+			stats::fallback();
+			return nmin;
+		}
 
-		return std::make_tuple(( (s_TE.status == opt::CONVERGED) ? n_TE : nmin ), 
-		( (s_TM.status == opt::CONVERGED) ? n_TM : nmin ));
+		opt::Status s;
+		if (seed)
+		{
+			double lo = std::max(seed->lo, nmax);
+			double hi = std::min(seed->hi, n2);
+			if (lo < hi)
+			{
+				auto n = opt::newton(slab, lo, hi, s, tol);
+				stats::record(s);
+				if (s.status == opt::CONVERGED)
+					return n;
+			}
+		}
+
+		auto n = opt::newton(slab, nmax, n2, s, tol);
+		stats::record(s);
+		if (s.status == opt::CONVERGED)
+			return n;
+
+		stats::fallback();
+		return nmin;
 	}
 
 	/**
-	 * \brief Return the mode profile for the TE or TM mode, for the dimension x.
-	 * 
-	 * The coordinate system is such that x = 0 at the first boundary
-	 * y
-	 * ^
-	 * | n1 | n2 | n3
-	 * |----0----W---> x
-	 * 
-	 * \param x the positions along the slab refractive index profile
-	 * \param A the field amplitude of the slab along the transverse dimension
-	 * \param Bl the field amplitude of the slab along the lateral dimension
-	 * \param Bn the field amplitude of the slab along the normal dimension
-	 * \param neff the effective refractive index for the slab
+	 * \brief Calculate the fields of 3 layer slab
 	 * \param n1 box refractive index
 	 * \param n2 core refractive index  
 	 * \param n3 cladding refractive index  
 	 * \param lambda Wavelength in meter
 	 * \param W extent of core; slab thickness
-	 * \param j the mode order to solve
-	 * 
-	 * \returns the field orthogonal to the transverse mode. If mode is TE, returns Hy. 
-	 * 	
-	 **/
-	template <Mode mode, typename I1, typename I2>
+	 * \param j the mode order to solve 
+	 * \returns the TE and TM effective refractive indices, or min(n1, n3) if the mode is not guided
+	 * \see solve_slab_mode
+	 */ 
+	std::tuple<double, double> 
+	solve_slab(double n1, double n2, double n3, double lambda, double W, int j)
+	{
+		return std::make_tuple(solve_slab_mode<TE>(n1, n2, n3, lambda, W, j), 
+			solve_slab_mode<TM>(n1, n2, n3, lambda, W, j));
+	}
+
+	/**
+	 * \brief Maximum number of mode orders returned by solve_slab_modes
+	 */
+	static constexpr size_t max_modes = 32;
+
+	/**
+	 * \brief The guided modes of one polarization of a 3 layer slab, by mode order
+	 */
+	struct slab_modes
+	{
+		std::array<double, max_modes> neff; ///< effective refractive indices of the guided orders
+		size_t count = 0; ///< number of guided orders, at most max_modes
+		double unguided = 0; ///< min(n1, n3), returned for the orders that are not guided
+
+		/**
+		 * \param j the mode order, j < max_modes
+		 * \returns the effective refractive index of order j, or unguided if the order is not guided
+		 **/
+		double
+		operator[](size_t j) const
+		{
+			return (j < count) ? neff[j] : unguided;
+		}
+	};
+
+	/**
+	 * \brief Solve every guided order of one polarization of the 3 layer slab
+	 *
+	 * With the transverse phase u = gamma2 * W, the characteristic equation reads
+	 * u = (j+1)*pi - phi1 - phi3, where each interface phase lies in [0, pi/2].
+	 * Order j is therefore confined to u in [j*pi, (j+1)*pi], i.e.
+	 * $n_{eff} \in [\sqrt{n_2^2 - ((j+1)\pi / k_0 W)^2}, \sqrt{n_2^2 - (j\pi / k_0 W)^2}]$,
+	 * and these brackets of the orders are disjoint.
+	 * The cutoffs follow from the V-number, V = k0 W sqrt(n2^2 - max(n1, n3)^2): order j is guided
+	 * if the characteristic equation is negative at max(n1, n3), or u(max(n1, n3)) = V
+	 * exceeds (j+1)*pi - phi1 - phi3 there.
+	 *
+	 * \see solve_slab_mode
+	 * \returns the guided modes, of decreasing effective refractive index
+	 */
+	template<Mode mode>
+	slab_modes
+	solve_slab_modes(double n1, double n2, double n3, double lambda, double W)
+	{
+		slab_modes modes;
+		modes.unguided = std::min(n1, n3);
+
+		auto nmax = std::max(n1, n3);
+		if (nmax >= n2)
+			return modes;
+
+		double k0W = 2*pi*(1 / lambda) * W;
+		double V = k0W * sqrt( (n2 - nmax) * (n2 + nmax) );
+
+		// The equation at max(n1, n3) is V + phi1 + phi3 - (j+1)*pi, the interface phases do not depend on j
+		double phase = pi - slab_equation<mode>(n1, n2, n3, lambda, W, 0, nmax);
+		size_t count = std::min<size_t>(std::max(std::ceil(phase / pi) - 1, 0.0), max_modes);
+
+		opt::Status s;
+		for (size_t j = 0; j < count; j++)
+		{
+			auto slab = [&n1, &n2, &n3, &lambda, &W, &j](double neff) {
+				return slab_equation_fdf<mode>(n1, n2, n3, lambda, W, j, neff);
+			};
+
+			double u_hi = j * pi;
+			double u_lo = std::min((j + 1) * pi, V);
+			double hi = sqrt( (n2 - u_hi / k0W) * (n2 + u_hi / k0W) );
+			double lo = std::max(sqrt( (n2 - u_lo / k0W) * (n2 + u_lo / k0W) ), nmax);
+
+			auto n = opt::newton(slab, lo, hi, s, tol);
+			stats::record(s);
+			if (s.status != opt::CONVERGED)
+				break;
+			modes.neff[j] = n;
+			modes.count = j + 1;
+		}
+
+		return modes;
+	}
+
+	/**
+	 * \brief Solve every guided order of the 3 layer slab
+	 * \returns the TE and TM guided modes
+	 * \see solve_slab_modes
+	 */
+	inline std::tuple<slab_modes, slab_modes>
+	solve_slab_all_modes(double n1, double n2, double n3, double lambda, double W)
+	{
+		return std::make_tuple(solve_slab_modes<TE>(n1, n2, n3, lambda, W),
+			solve_slab_modes<TM>(n1, n2, n3, lambda, W));
+	}
+
+	/**
+	 * \brief Cache of the vertical slab solves of one polarization
+	 * \param mode TE or TM
+	 * \returns the process wide cache of solve_vertical_mode for the polarization, of at most 2^18 slabs,
+	 * as a server answers requests of any stack for as long as it runs
+	 */
+	inline memo<slab_key, double, slab_key_hash>&
+	vertical_cache(Mode mode)
+	{
+		using vertical_memo = memo<slab_key, double, slab_key_hash>;
+		constexpr size_t capacity = size_t(1) << 18;
+		static vertical_memo cache[2] = {vertical_memo(capacity), vertical_memo(capacity)};
+		return cache[mode];
+	}
+
+	/**
+	 * \brief Memoized solve_slab_mode for the vertical stage of the effective index method.
+	 * The vertical slabs depend only on the material stack, wavelength and thickness,
+	 * so they repeat for every width, gap and mode order of a sweep.
+	 * The polarizations are cached apart, so that a waveguide solves only the one its mode takes.
+	 * \param mode TE or TM
+	 * \see solve_slab_mode
+	 */
+	inline double
+	solve_vertical_mode(Mode mode, double n1, double n2, double n3, double lambda, double W, int j = 0)
+	{
+		stats::timer t(stats::VERTICAL);
+		return vertical_cache(mode)(slab_key{n1, n2, n3, lambda, W, j}, [&]() {
+			return (mode == TE) ? solve_slab_mode<TE>(n1, n2, n3, lambda, W, j) : solve_slab_mode<TM>(n1, n2, n3, lambda, W, j);
+		});
+	}
+
+	/**
+	 * \brief Memoized solve_slab for the vertical stage of the effective index method.
+	 * \returns the TE and TM effective refractive indices
+	 * \see solve_vertical_mode
+	 */
+	inline std::tuple<double, double>
+	solve_vertical(double n1, double n2, double n3, double lambda, double W, int j = 0)
+	{
+		return std::make_tuple(solve_vertical_mode(TE, n1, n2, n3, lambda, W, j),
+			solve_vertical_mode(TM, n1, n2, n3, lambda, W, j));
+	}
+
+	/**
+	 * \brief Differentiate a root of one polarization of the 3 layer slab along the parameter of the jets
+	 * \param neff the root, as from solve_slab_mode
+	 * \returns neff with its derivatives; the jet of min(n1, n3) if the mode is not guided
+	 * \see ad::implicit
+	 */
+	template<Mode mode>
+	ad::jet2
+	slab_mode_jet(const ad::jet2& n1, const ad::jet2& n2, const ad::jet2& n3, const ad::jet2& lambda,
+		double W, int j, double neff)
+	{
+		if (!(neff > std::max(n1.v, n3.v)))
+			return std::min(n1, n3);
+
+		return ad::implicit([&](const ad::jet2& n) {
+			return slab_equation<mode>(n1, n2, n3, lambda, W, j, n);
+		}, neff);
+	}
+
+	/**
+	 * \brief The vertical stage with its derivatives along the wavelength
+	 * \param lambda the wavelength, as the jet (lambda, 1, 0)
+	 * \returns the TE and TM effective refractive indices of the slab
+	 * \see solve_vertical
+	 */
+	inline std::tuple<ad::jet2, ad::jet2>
+	solve_vertical_jet(double n1, double n2, double n3, const ad::jet2& lambda, double W)
+	{
+		auto [te, tm] = solve_vertical(n1, n2, n3, lambda.v, W, 0);
+		return std::make_tuple(slab_mode_jet<TE>(n1, n2, n3, lambda, W, 0, te),
+			slab_mode_jet<TM>(n1, n2, n3, lambda, W, 0, tm));
+	}
+
+	/**
+	 * \returns the group index, $n_g = n_{eff} - \lambda \, dn_{eff}/d\lambda$
+	 */
+	inline double
+	group_index(const ad::jet2& neff, double lambda)
+	{
+		return neff.v - lambda * neff.d;
+	}
+
+	/**
+	 * \returns the dispersion parameter, $D = -\frac{\lambda}{c} \frac{d^2 n_{eff}}{d\lambda^2}$,
+	 * in ps/(nm km) for the wavelength in um
+	 */
+	inline double
+	dispersion_D(const ad::jet2& neff, double lambda)
+	{
+		// s/m^2 from um, and 1 s/m^2 = 1e6 ps/(nm km)
+		return -lambda * neff.dd / c * 1e6 * 1e6;
+	}
+
+	/**
+	 * \brief Apply f to the blocks of [i0, i1), in parallel for large ranges
+	 * \param f callable on each block, f(k0, k1)
+	 */
+	template<typename F>
 	void
-	mode_1D(I1 x1, I2 x2, field_t* A, field_t* Bl, field_t* Bn,
-		double neff, double n1, double n2, double n3, double lambda, double W, int j)
+	for_each_block(size_t i0, size_t i1, size_t block, F&& f)
 	{
-		const size_t xs = std::distance(x1, x2);
-		const auto x = &(*x1);
+		#if PARALLEL
+		// Below a few thousand points the thread launch costs more than the evaluation
+		if (i1 - i0 >= (1 << 14))
+		{
+			std::vector<size_t> blocks((i1 - i0 + block - 1) / block);
+			std::iota(blocks.begin(), blocks.end(), 0);
+			std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](const size_t& k)
+			{
+				size_t k0 = i0 + k * block;
+				f(k0, std::min(i1, k0 + block));
+			});
+			return;
+		}
+		#endif
+
+		for (size_t k0 = i0; k0 < i1; k0 += block)
+			f(k0, std::min(i1, k0 + block));
+	}
+
+	/**
+	 * \brief The step of a uniform grid, e.g. from vec::linspace
+	 * \returns the step, or 0 if the grid is not uniform
+	 */
+	inline double
+	uniform_step(const double* x, size_t xs)
+	{
+		const double h = (xs > 1) ? (x[xs - 1] - x[0]) / (xs - 1) : 0;
+		bool uniform = xs > 1 && h > 0;
+		for (size_t i = 0; uniform && i < xs; i++)
+			uniform = std::fabs(x[i] - (x[0] + h * i)) <= 1e-9 * h;
+		return uniform ? h : 0;
+	}
+
+	/**
+	 * \brief Evaluate C * exp(g * (x - x0)) over the points [i0, i1) of a sorted grid
+	 *
+	 * On a uniform grid each block of points is generated from one exp at its first point, times a table
+	 * of the progression over the step. The table is built from exact powers at every 8th step,
+	 * so it holds to a few ulp.
+	 *
+	 * \param h the step of the grid, from uniform_step
+	 * \param f callable on each point, f(i, value)
+	 */
+	template<typename F>
+	void
+	exp_region(const double* x, size_t i0, size_t i1, double h, double C, double g, double x0, F&& f)
+	{
+		constexpr size_t block = 64;
+		if (i1 <= i0)
+			return;
+
+		if (!h)
+		{
+			for (size_t i = i0; i < i1; i++)
+				f(i, C * exp(g * (x[i] - x0)));
+			return;
+		}
 
+		alignas(64) double step[block];
+		double fine[8], coarse[block / 8];
+		for (size_t m = 0; m < 8; m++)
+			fine[m] = exp(g * h * m);
+		for (size_t m = 0; m < block / 8; m++)
+			coarse[m] = exp(g * h * 8 * m);
+		for (size_t m = 0; m < block; m++)
+			step[m] = coarse[m / 8] * fine[m % 8];
+
+		for_each_block(i0, i1, block, [&](size_t k0, size_t k1)
+		{
+			const double anchor = C * exp(g * (x[k0] - x0));
+			for (size_t i = k0; i < k1; i++)
+				f(i, anchor * step[i - k0]);
+		});
+	}
+
+	/**
+	 * \brief Evaluate cos(k * x + phase) and sin(k * x + phase) over the points [i0, i1) of a sorted grid
+	 *
+	 * On a uniform grid each block of points is generated from one sincos at its first point, rotated by
+	 * a table of the rotations over the step, composed from the rotations by m % 8 and 8 * (m / 8) steps.
+	 *
+	 * \param h the step of the grid, from uniform_step
+	 * \param f callable on each point, f(i, cos, sin)
+	 */
+	template<typename F>
+	void
+	cos_region(const double* x, size_t i0, size_t i1, double h, double k, double phase, F&& f)
+	{
+		constexpr size_t block = 64;
+		if (i1 <= i0)
+			return;
+
+		if (!h)
+		{
+			for (size_t i = i0; i < i1; i++)
+				f(i, cos(k * x[i] + phase), sin(k * x[i] + phase));
+			return;
+		}
+
+		alignas(64) double cs[block], sn[block];
+		double fc[8], fs[8], cc[block / 8], cn[block / 8];
+		for (size_t m = 0; m < 8; m++)
+		{
+			fc[m] = cos(k * h * m);
+			fs[m] = sin(k * h * m);
+		}
+		for (size_t m = 0; m < block / 8; m++)
+		{
+			cc[m] = cos(k * h * 8 * m);
+			cn[m] = sin(k * h * 8 * m);
+		}
+		for (size_t m = 0; m < block; m++)
+		{
+			cs[m] = cc[m / 8] * fc[m % 8] - cn[m / 8] * fs[m % 8];
+			sn[m] = cn[m / 8] * fc[m % 8] + cc[m / 8] * fs[m % 8];
+		}
+
+		for_each_block(i0, i1, block, [&](size_t k0, size_t k1)
+		{
+			const double ca = cos(k * x[k0] + phase);
+			const double sa = sin(k * x[k0] + phase);
+			for (size_t i = k0; i < k1; i++)
+			{
+				size_t m = i - k0;
+				f(i, ca * cs[m] - sa * sn[m], sa * cs[m] + ca * sn[m]);
+			}
+		});
+	}
+
+	/**
+	 * \brief Constants of the mode profile of a 3 layer slab, in the coordinates of mode_1D
+	 * The profile is C1 exp(gamma1 x) below 0, C2 cos(gamma2 x + alpha) in the core and
+	 * C3 exp(-gamma3 (x - W)) above W.
+	 */
+	struct slab_profile
+	{
+		double gamma1; ///< decay constant of region 1
+		double gamma2; ///< transverse wavenumber of the core
+		double gamma3; ///< decay constant of region 3
+		double alpha;  ///< phase of the core at x = 0
+		double C1;     ///< amplitude of region 1
+		double C2;     ///< amplitude of the core
+		double C3;     ///< amplitude of region 3
+	};
+
+	/**
+	 * \brief calculate the constants of the mode profile of a 3 layer slab, with C2 = 1
+	 * \see mode_1D
+	 */
+	template<Mode mode>
+	slab_profile
+	slab_coefficients(double neff, double n1, double n2, double n3, double lambda, double W, int j)
+	{
 		double k0 = 2*pi*(1 / lambda); 
 		double gamma1 = k0*sqrt( pow(neff, 2) - pow(n1, 2) );
 		double gamma2 = k0*sqrt( pow(n2, 2) - pow(neff, 2) );
@@ -154,7 +561,19 @@ namespace eim
 		double C3 = C2 * cos(gamma2 * W + alpha) * \
 			( (mode == TM) ? pow(n2, 2) / pow(n3, 2) : 1.0 );
 
-		#if 0 // this is for field normalization if desired in the future
+		return {gamma1, gamma2, gamma3, alpha, C1, C2, C3};
+	}
+
+	/**
+	 * \brief Integrals of the intensity of the mode profile of a 3 layer slab by region, in closed form
+	 * \returns $\int |A|^2 dx$ below 0, over the core and above W, of the profile of mode_1D
+	 */
+	template<Mode mode>
+	std::array<double, 3>
+	slab_power(double neff, double n1, double n2, double n3, double lambda, double W, int j)
+	{
+		const auto [gamma1, gamma2, gamma3, alpha, C1, C2, C3] = slab_coefficients<mode>(neff, n1, n2, n3, lambda, W, j);
+
 		// Region 1: x from -∞ to 0: 
 		// $A_1 = \int_{-\inf}^{0} |C_1 e^(\gamma_1 x)|^2!~dx = C_1^2 / (2 gamma_1)$
 		double A1 = pow(C1, 2) / (2.0 * gamma1);
@@ -164,70 +583,140 @@ namespace eim
 		// Region 3: x from W to +∞:
 		// $A_3 = \int_W^\inf |C_3 e^(-\gamma_3*(x-W))|^2~dx = C_3^2 / (2*\gamma_3)$
 		double A3 = pow(C3, 2) / (2.0 * gamma3);
-		#endif
 
+		return {A1, A2, A3};
+	}
 
-		auto calculate_field = [&](size_t& i)
-		{
-			constexpr std::complex<double> j(1.0, 1.0);
+	/**
+	 * \brief Return the mode profile for the TE or TM mode, for the dimension x.
+	 * 
+	 * The coordinate system is such that x = 0 at the first boundary
+	 * y
+	 * ^
+	 * | n1 | n2 | n3
+	 * |----0----W---> x
+	 * 
+	 * The positions must be sorted, as from vec::linspace, so that each region is a contiguous sub-range.
+	 * The regions are evaluated separately with their constants hoisted, and on uniform grids
+	 * the exponential tails and the core cosine are generated by progressions over blocks of points.
+	 * \see exp_region, cos_region
+	 * 
+	 * \param x the positions along the slab refractive index profile
+	 * \tparam components mask of the components to evaluate; the outputs of the others are not written and may be null
+	 * \tparam T the element type of the outputs, e.g. std::complex<float> for exports; the profile is evaluated in double
+	 * \param A the field amplitude of the slab along the transverse dimension
+	 * \param Bl the field amplitude of the slab along the lateral dimension
+	 * \param Bn the field amplitude of the slab along the normal dimension
+	 * \param neff the effective refractive index for the slab
+	 * \param n1 box refractive index
+	 * \param n2 core refractive index  
+	 * \param n3 cladding refractive index  
+	 * \param lambda Wavelength in meter
+	 * \param W extent of core; slab thickness
+	 * \param j the mode order to solve
+	 * 
+	 * \returns the field orthogonal to the transverse mode. If mode is TE, returns Hy. 
+	 * 	
+	 **/
+	template <Mode mode, uint8_t components = ALL_FIELDS, typename T = field_t, typename I1, typename I2>
+	void
+	mode_1D(I1 x1, I2 x2, std::type_identity_t<T>* A, std::type_identity_t<T>* Bl, std::type_identity_t<T>* Bn,
+		double neff, double n1, double n2, double n3, double lambda, double W, int j)
+	{
+		const size_t xs = std::distance(x1, x2);
+		const auto x = &(*x1);
 
-			if (x[i] < 0)
-			{
-				A[i] = C1 * exp(gamma1 * x[i]);
+		const auto [gamma1, gamma2, gamma3, alpha, C1, C2, C3] = slab_coefficients<mode>(neff, n1, n2, n3, lambda, W, j);
 
-				Bl[i] = (mode == TE) ?
-					A[i] * n1 / eta0 :
-					A[i] * eta0 / n1;
+		// The grid is split into the contiguous sub-ranges of its three regions up front
+		const size_t r1 = std::partition_point(x, x + xs, [](double xi) { return xi < 0; }) - x;
+		const size_t r2 = std::partition_point(x + r1, x + xs, [&W](double xi) { return xi <= W; }) - x;
 
-				Bn[i] = ((mode == TE) ?
-					(-gamma1 * A[i]) / (j * 2.*pi*c/lambda *mu0) :
-					(gamma1 * A[i] ) / (j * 2.*pi*c/lambda * eps0 * pow(n1, 2)));
-			}
-			else if (x[i] >= 0 && x[i] <= W)
-			{
-				A[i] = C2 * cos(gamma2 * x[i] + alpha);
+		// Per region constants, such that Bl = bl * A and Bn = kn * (A, or the sine term in the core)
+		constexpr std::complex<double> j_(0.0, 1.0);
+		const double omega = 2.*pi*c/lambda;
+		const double bl = (mode == TE) ? n1 / eta0 : eta0 / n1;
+		const field_t kn1 = (mode == TE) ? -gamma1 / (j_ * omega * mu0) : gamma1 / (j_ * omega * eps0 * n1 * n1);
+		const field_t kn2 = (mode == TE) ? C2 * gamma2 / (j_ * omega * mu0) : -C2 * gamma2 / (j_ * omega * eps0 * n2 * n2);
+		const field_t kn3 = (mode == TE) ? gamma3 / (j_ * omega * mu0) : gamma3 / (j_ * omega * eps0 * n3 * n3);
 
-				Bl[i] = (mode == TE) ?
-					A[i] * n1 / eta0 :
-					A[i] * eta0 / n1;
+		const double h = uniform_step(x, xs);
 
-				auto normal = C2 * gamma2 * sin(gamma2 * x[i] + alpha);
-				Bn[i] = ((mode == TE) ? normal /(j * 2.*pi*c/lambda *mu0) :
-					-normal  / (j * 2.*pi*c/lambda * eps0 * pow(n2, 2)));
-			}
-			else if (x[i] > W)
+		// C * exp(g * (x - x0)), for the evanescent tails
+		auto tail = [&](size_t i0, size_t i1, double C, double g, double x0, const field_t& kn)
+		{
+			exp_region(x, i0, i1, h, C, g, x0, [&](size_t i, double a)
 			{
-				A[i] = C3 * exp(-gamma3 * (x[i] - W));
-
-				Bl[i] = (mode == TE) ?
-					A[i] * n1 / eta0 :
-					A[i] * eta0 / n1;
-
-				Bn[i] = ((mode == TE) ?
-					(gamma3 * A[i]) / (j * 2.*pi*c/lambda *mu0) :
-					(gamma3 * A[i] ) / (j * 2.*pi*c/lambda * eps0 * pow(n3, 2)));
-			}
+				if constexpr (components & TRANSVERSE_FIELD) A[i] = T(a);
+				if constexpr (components & LATERAL_FIELD) Bl[i] = T(a * bl);
+				if constexpr (components & NORMAL_FIELD) Bn[i] = T(kn * a);
+			});
 		};
 
-		#if PARALLEL
-			// C++ supports parallel execution policies but under the hood it depends on libtbb 
-			std::for_each(std::execution::par, x1, x2, [&](const double& xi) 
+		// C2 * cos(gamma2 * x + alpha), for the core
+		auto core = [&](size_t i0, size_t i1)
+		{
+			cos_region(x, i0, i1, h, gamma2, alpha, [&](size_t i, double cs, double sn)
 			{
-				//Requires that the storage container is contiguous
-				//xi must be passed by reference
-				size_t i = &xi - &x[0];
-				calculate_field(i);
-			});	
-		#else
+				double a = C2 * cs;
+				if constexpr (components & TRANSVERSE_FIELD) A[i] = T(a);
+				if constexpr (components & LATERAL_FIELD) Bl[i] = T(a * bl);
+				if constexpr (components & NORMAL_FIELD) Bn[i] = T(kn2 * sn);
+			});
+		};
+
+		tail(0, r1, C1, gamma1, 0, kn1);
+		core(r1, r2);
+		tail(r2, xs, C3, -gamma3, W, kn3);
+	}
+
+	/**
+	 * \brief Return one component of the mode profile for the TE or TM mode, for the dimension x
+	 * Only the requested component is evaluated. \see mode_1D
+	 * \param F the field amplitude of the component
+	 * \param component the component
+	 **/
+	template <Mode mode, typename T, typename I1, typename I2>
+	void
+	mode_component(I1 x1, I2 x2, T* F, Component component,
+		double neff, double n1, double n2, double n3, double lambda, double W, int j)
+	{
+		switch (component)
 		{
-		       //standard serial execution of the calculation
-		       for(size_t i = 0; i < xs; i++)
-		       {
-		               calculate_field(i);
-		       }
+			case LATERAL_FIELD:
+				mode_1D<mode, LATERAL_FIELD, T>(x1, x2, nullptr, F, nullptr, neff, n1, n2, n3, lambda, W, j);
+				break;
+			case NORMAL_FIELD:
+				mode_1D<mode, NORMAL_FIELD, T>(x1, x2, nullptr, nullptr, F, neff, n1, n2, n3, lambda, W, j);
+				break;
+			default:
+				mode_1D<mode, TRANSVERSE_FIELD, T>(x1, x2, F, nullptr, nullptr, neff, n1, n2, n3, lambda, W, j);
 		}
-		#endif
+	}
+
+	/**
+	 * \brief calculate the effective refractive index of a strip waveguide, specialized on its mode
+	 * \tparam mode TE or TM mode of the waveguide
+	 * \param m the material stack
+	 * \param seed optional bracket of the effective refractive index of the horizontal stage
+	 * \returns the effective refractive index
+	 * \see Strip
+	 */
+	template<Mode mode>
+	double
+	strip_neff(const stack& m, double t_rib, double t_slab, double lambda, double w_rib, int j,
+		const std::optional<opt::bracket>& seed = std::nullopt)
+	{
+		auto n1 = solve_vertical_mode(mode, m.n_box, (t_slab ? m.n_core : m.n_clad), m.n_clad, lambda, t_slab, 0);
+		auto n2 = solve_vertical_mode(mode, m.n_box, m.n_core, m.n_clad, lambda, t_rib, 0);
+		const auto& n3 = n1;
+
+		stats::timer t(stats::HORIZONTAL);
 
+		// The TE mode of the waveguide is the TM mode of the analysis
+		// For TM mode analysis, it is the opposite order
+		constexpr Mode analysis = (mode == TE) ? TM : TE;
+		return solve_slab_mode<analysis>(n1, n2, n3, lambda, w_rib, j, seed);
 	}
 
 	/**
@@ -263,29 +752,91 @@ namespace eim
 
 		/**
 		 * \brief calculate the effective refractive index
+		 * \param seed optional bracket of the effective refractive index of the horizontal stage
 		 * \returns the effective refractive index 
 		 **/
 		double 
-		operator()()
+		operator()(const std::optional<opt::bracket>& seed = std::nullopt)
+		{
+			stack m{n_box, n_core, n_clad, n_clad};
+			if (mode == TE)
+				return strip_neff<TE>(m, t_rib, t_slab, wavelength, w_rib, mode_order, seed);
+			else //(mode == TM)
+				return strip_neff<TM>(m, t_rib, t_slab, wavelength, w_rib, mode_order, seed);
+		}
+
+		/**
+		 * \returns the effective refractive index of the outer regions, which a mode that is not guided takes
+		 **/
+		double
+		cladding_index()
+		{
+			auto n1 = solve_vertical(n_box, (t_slab ? n_core : n_clad), n_clad, wavelength, t_slab, 0);
+			return (mode == TE) ? get<0>(n1) : get<1>(n1);
+		}
+
+		/**
+		 * \brief differentiate the effective refractive index along the wavelength
+		 * The roots of the vertical and horizontal stages are differentiated implicitly, for
+		 * materials without dispersion, so no further solves are needed.
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns neff, dneff/dlambda and d^2neff/dlambda^2
+		 **/
+		ad::jet2
+		dispersion(double neff)
 		{
-			
-			auto n1 = solve_slab(n_box, (t_slab ? n_core : n_clad), n_clad, wavelength, t_slab, 0);
-			auto n2 = solve_slab(n_box, n_core, n_clad, wavelength, t_rib, 0);
+			ad::jet2 l(wavelength, 1);
+			auto n1 = solve_vertical_jet(n_box, (t_slab ? n_core : n_clad), n_clad, l, t_slab);
+			auto n2 = solve_vertical_jet(n_box, n_core, n_clad, l, t_rib);
 			const auto& n3 = n1;
 
-			// The TE mode of the waveguide is the TM mode of the analysis
-			// For TM mode analysis, it is the opposite order
-			if (mode ==  TE)
-			{
-				auto neff = solve_slab(get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib, mode_order);
-				return get<1>(neff);
-			}
+			if (mode == TE)
+				return slab_mode_jet<TM>(get<0>(n1), get<0>(n2), get<0>(n3), l, w_rib, mode_order, neff);
 			else //(mode == TM)
-			{
-				auto neff = solve_slab(get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib, mode_order);
-				return get<0>(neff);
-			}
+				return slab_mode_jet<TE>(get<1>(n1), get<1>(n2), get<1>(n3), l, w_rib, mode_order, neff);
 		}
+
+		/**
+		 * \brief calculate the effective refractive index of every guided mode order in one pass
+		 * \note mode_order is not used
+		 * \returns the guided modes of the horizontal stage
+		 * \see solve_slab_modes
+		 **/
+		slab_modes
+		modes()
+		{
+			auto n1 = solve_vertical(n_box, (t_slab ? n_core : n_clad), n_clad, wavelength, t_slab, 0);
+			auto n2 = solve_vertical(n_box, n_core, n_clad, wavelength, t_rib, 0);
+			const auto& n3 = n1;
+
+			stats::timer t(stats::HORIZONTAL);
+			if (mode == TE)
+				return solve_slab_modes<TM>(get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib);
+			else //(mode == TM)
+				return solve_slab_modes<TE>(get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib);
+		}
+
+		/**
+		 * \brief calculate the power of the mode field by region in closed form, without evaluating the field
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns the power of the lateral profile in the slab, rib and slab,
+		 * and of the vertical profile in the box, core and cladding
+		 **/
+		mode_power<3>
+		power(double neff)
+		{
+			auto n1 = solve_vertical(n_box, (t_slab ? n_core : n_clad), n_clad, wavelength, t_slab, 0);
+			auto n2 = solve_vertical(n_box, n_core, n_clad, wavelength, t_rib, 0);
+			const auto& n3 = n1;
+
+			if (mode == TE)
+				return {slab_power<TM>(neff, get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib, mode_order),
+					slab_power<TE>(get<0>(n2), n_box, n_core, n_clad, wavelength, t_rib, 0)};
+			else // (mode == TM)
+				return {slab_power<TE>(neff, get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib, mode_order),
+					slab_power<TM>(get<1>(n2), n_box, n_core, n_clad, wavelength, t_rib, 0)};
+		}
+
 		/**
 		 * \brief calculate the mode field amplitude
 		 * \param x the span of points in x and y to calculate the field amplitude for
@@ -294,47 +845,77 @@ namespace eim
 		void 
 		mode_2D(cvector<double>& x, cmatrix<field_t>& field)
 		{
-			size_t N = std::distance(x.begin(), x.end());
-			//Vertical field amplitude
-			cvector<field_t> E_slab ( N );
-			cvector<field_t> H_slab ( N );
-			cvector<field_t> _ ( N );
-
-			cvector<field_t> E_wg( N );
-			cvector<field_t> H_wg( N );
-			
+			mode_2D(x, &field[0]);
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude into row storage, e.g. a mapped grid_file record
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \param field the rows of the field amplitude, x.size() rows of x.size() points
+		 **/
+		void 
+		mode_2D(cvector<double>& x, field_t** field)
+		{
+			mode_field(x, (*this)(), scratch_field()).materialize(field);
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude as the product of its 1D profiles
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \returns the field, with the lateral waveguide profile along the rows and the vertical slab profile along the columns
+		 **/
+		separable_field<field_t>
+		mode_field(const cvector<double>& x)
+		{
+			return mode_field(x, (*this)());
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude of a solved effective refractive index
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \param neff the effective refractive index, as from operator()
+		 * \returns the field, with the lateral waveguide profile along the rows and the vertical slab profile along the columns
+		 **/
+		separable_field<field_t>
+		mode_field(const cvector<double>& x, double neff)
+		{
+			separable_field<field_t> field;
+			mode_field(x, neff, field);
+			return field;
+		}
+
+		/**
+		 * \brief calculate the mode field amplitude of a solved effective refractive index into a field, reusing its storage
+		 * The vertical stage is the one of operator(), which is answered from the vertical cache.
+		 * \param x the span of points in x and y to calculate the field amplitude for
+		 * \param neff the effective refractive index, as from operator()
+		 * \param field the field, e.g. the scratch_field of the thread, of complex double or of complex float for exports
+		 * \param component the component of the lateral profile along the rows, the transverse field by default
+		 * \returns the field
+		 **/
+		template<typename T>
+		separable_field<T>&
+		mode_field(const cvector<double>& x, double neff, separable_field<T>& field, Component component = TRANSVERSE_FIELD)
+		{
+			stats::timer t(stats::FIELD);
+			field.assign(x.begin(), x.end(), x.begin(), x.end());
+
+			auto n1 = solve_vertical(n_box, (t_slab ? n_core : n_clad) , n_clad, wavelength, t_slab, 0); 
+			auto n2 = solve_vertical(n_box, n_core , n_clad, wavelength, t_rib, 0);
+			const auto& n3 = n1;
+
 			if (mode == TE)
 			{	
-				auto n1 = solve_slab(n_box, (t_slab ? n_core : n_clad) , n_clad, wavelength, t_slab, mode_order); 
-				auto n2 = solve_slab(n_box, n_core , n_clad, wavelength, t_rib, mode_order);
-				const auto& n3 = n1;
-				mode_1D<TE>(x.begin(), x.end(), E_slab.begin(), H_slab.begin(), _.begin(), get<0>(n2), n_box, n_core, n_clad, wavelength, t_rib, mode_order);
-				auto neff = solve_slab(get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib, mode_order);
-				mode_1D<TM>(x.begin(), x.end(), H_wg.begin(), E_wg.begin(), _.begin(),  get<1>(neff), get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib, mode_order);
-				
-				#if PARALLEL
-					vec::async_outer_product<field_t>(H_wg.begin(), H_wg.end(), E_slab.begin(), E_slab.end(), &field[0]);
-				#else
-					vec::outer_product<field_t>(H_wg.begin(), H_wg.end(), E_slab.begin(), E_slab.end(), &field[0]);
-				#endif
+				mode_1D<TE, TRANSVERSE_FIELD, T>(x.begin(), x.end(), field.v.data(), nullptr, nullptr, get<0>(n2), n_box, n_core, n_clad, wavelength, t_rib, 0);
+				mode_component<TM>(x.begin(), x.end(), field.u.data(), component, neff, get<0>(n1), get<0>(n2), get<0>(n3), wavelength, w_rib, mode_order);
 			}
 			else // (mode == TM)
 			{
-				auto n1 = solve_slab(n_box, (t_slab ? n_core : n_clad) , n_clad, wavelength, t_slab, mode_order); 
-				auto n2 = solve_slab(n_box, n_core , n_clad, wavelength, t_rib, mode_order);
-				const auto& n3 = n1;
-				mode_1D<TM>(x.begin(), x.end(), H_slab.begin(), E_slab.begin(), _.begin(), get<1>(n2), n_box, n_core, n_clad, wavelength, t_rib, mode_order);
-				auto neff = solve_slab(get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib, mode_order);
-				mode_1D<TE>(x.begin(), x.end(), E_wg.begin(), H_wg.begin(), _.begin(), get<0>(neff), get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib, mode_order);
-				
-				#if PARALLEL
-					vec::async_outer_product<field_t>(E_wg.begin(), E_wg.end(), H_slab.begin(), H_slab.end(), &field[0]);
-				#else
-					vec::outer_product<field_t>(E_wg.begin(), E_wg.end(), H_slab.begin(), H_slab.end(), &field[0]);
-				#endif
+				mode_1D<TM, TRANSVERSE_FIELD, T>(x.begin(), x.end(), field.v.data(), nullptr, nullptr, get<1>(n2), n_box, n_core, n_clad, wavelength, t_rib, 0);
+				mode_component<TE>(x.begin(), x.end(), field.u.data(), component, neff, get<1>(n1), get<1>(n2), get<1>(n3), wavelength, w_rib, mode_order);
 			}
 
-
+			return field;
 		}
 	};
 
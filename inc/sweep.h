@@ -0,0 +1,359 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+/**
+ * \brief Parameter sweep engine.
+ * \file sweep.h Parallel Parameter Sweep Definitions
+ * \author c. papakonstantinou
+ */
+// Copyright (c) 2025  Constantine Papakonstantinou
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <span>
+#include <vector>
+#include <numeric>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <eim.h>
+#include <libopt.h>
+
+namespace eim
+{
+	/**
+	 * \brief A single point of the sweep space
+	 */
+	struct point
+	{
+		double wavelength;   ///< wavelength
+		double gap;          ///< slot width, 0 if the sweep has no gaps
+		double width;        ///< rib/core width
+		unsigned mode_order; ///< mode order
+		size_t index;        ///< flat index of the point in its sweep
+	};
+
+	/**
+	 * \brief set the axis of a point
+	 */
+	inline void
+	set(point& p, Axis axis, double x)
+	{
+		if (axis == WAVELENGTH)
+			p.wavelength = x;
+		else if (axis == GAP)
+			p.gap = x;
+		else
+			p.width = x;
+	}
+
+	/**
+	 * \brief Cartesian product of the sweep-able parameters flattened into one index space.
+	 *
+	 * The index is ordered as the nested loops of a sweep:
+	 * wavelength (slowest), gap, width, mode order (fastest).
+	 * An empty axis is treated as a single point of value 0.
+	 **/
+	struct sweep
+	{
+		std::span<const double> wavelengths;   ///< wavelengths to solve
+		std::span<const double> gaps;          ///< slot widths to solve
+		std::span<const double> widths;        ///< widths to solve
+		std::span<const unsigned> mode_orders; ///< mode orders to solve
+
+		/**
+		 * \returns the number of points in the sweep
+		 **/
+		size_t
+		size() const
+		{
+			return dim(wavelengths) * dim(gaps) * dim(widths) * dim(mode_orders);
+		}
+
+		/**
+		 * \brief decode a flat index into its sweep point
+		 * \param i the flat index
+		 * \returns the point at index i
+		 **/
+		point
+		operator[](size_t i) const
+		{
+			point p;
+			p.index = i;
+			p.mode_order = at(mode_orders, i % dim(mode_orders)); i /= dim(mode_orders);
+			p.width = at(widths, i % dim(widths)); i /= dim(widths);
+			p.gap = at(gaps, i % dim(gaps)); i /= dim(gaps);
+			p.wavelength = at(wavelengths, i);
+			return p;
+		}
+
+		private:
+		template<typename T>
+		static size_t dim(std::span<const T> v) { return std::max<size_t>(v.size(), 1); }
+
+		template<typename T>
+		static T at(std::span<const T> v, size_t i) { return v.empty() ? T(0) : v[i]; }
+	};
+
+	/**
+	 * \brief Solve the points [first, last) of a sweep into a preallocated table.
+	 *
+	 * The table is indexed by the flat sweep index less first, so the output order is deterministic
+	 * regardless of how the points are scheduled, e.g. for the shard of a sweep of one node.
+	 *
+	 * \param s the sweep
+	 * \param first the flat index of the first point
+	 * \param last the flat index past the last point
+	 * \param table storage for the results, resized to last - first
+	 * \param f callable that solves a point, R f(const point&); the point has its flat index in s
+	 **/
+	template<typename R, typename F>
+	void
+	solve_sweep(const sweep& s, size_t first, size_t last, std::vector<R>& table, F&& f)
+	{
+		table.resize(last - first);
+
+		#if PARALLEL
+			// The parallel policy is backed by libtbb, which distributes the range by work-stealing
+			std::for_each(std::execution::par, table.begin(), table.end(), [&](R& r)
+			{
+				//Requires that the storage container is contiguous
+				size_t i = &r - &table[0];
+				r = f(s[first + i]);
+			});
+		#else
+		{
+			for (size_t i = 0; i < table.size(); i++)
+				table[i] = f(s[first + i]);
+		}
+		#endif
+	}
+
+	/**
+	 * \brief Solve every point of a sweep into a preallocated table.
+	 *
+	 * The table is indexed by the flat sweep index, so the output order is deterministic
+	 * regardless of how the points are scheduled. Formatting the results is left to the caller,
+	 * once all the points are solved.
+	 *
+	 * \param s the sweep
+	 * \param table storage for the results, resized to s.size()
+	 * \param f callable that solves a point, R f(const point&)
+	 **/
+	template<typename R, typename F>
+	void
+	solve_sweep(const sweep& s, std::vector<R>& table, F&& f)
+	{
+		solve_sweep(s, 0, s.size(), table, std::forward<F>(f));
+	}
+
+	/**
+	 * \brief An interval of a sweep axis, sampled adaptively to its effective refractive index
+	 */
+	struct adaptive_range
+	{
+		double lo;         ///< lower end of the interval
+		double hi;         ///< upper end of the interval
+		double tol = 1e-4; ///< largest error of the linear interpolation of neff between the points
+	};
+
+	/**
+	 * \brief Sample an interval where the linear interpolation of f misses it by more than the tolerance.
+	 *
+	 * The interval starts as a uniform grid, and every interval whose midpoint is missed by the
+	 * interpolation of its ends on any line is bisected, level by level. The solves of a level
+	 * are in parallel.
+	 *
+	 * \param r the interval and tolerance
+	 * \param lines the number of lines sampled together, e.g. the points of the other axes
+	 * \param f callable double f(double x, size_t line)
+	 * \param seed the intervals of the initial grid
+	 * \param max_depth the most bisections of an interval of the initial grid
+	 * \returns the sorted points of the interval
+	 **/
+	template<typename F>
+	std::vector<double>
+	refine(const adaptive_range& r, size_t lines, F&& f, size_t seed = 8, size_t max_depth = 12)
+	{
+		std::vector<double> x(seed + 1);
+		for (size_t i = 0; i <= seed; i++)
+			x[i] = r.lo + (r.hi - r.lo) * i / seed;
+		x.back() = r.hi;
+
+		std::vector<std::vector<double>> v; // v[point][line]
+		auto evaluate = [&](size_t i0)
+		{
+			v.resize(x.size(), std::vector<double>(lines));
+			std::vector<size_t> tasks((x.size() - i0) * lines);
+			std::iota(tasks.begin(), tasks.end(), 0);
+			auto solve = [&](const size_t& k) { v[i0 + k / lines][k % lines] = f(x[i0 + k / lines], k % lines); };
+			#if PARALLEL
+				std::for_each(std::execution::par, tasks.begin(), tasks.end(), solve);
+			#else
+				std::for_each(tasks.begin(), tasks.end(), solve);
+			#endif
+		};
+		evaluate(0);
+
+		// Intervals by the indices of their ends
+		std::vector<std::pair<size_t, size_t>> pending, next;
+		for (size_t i = 0; i < seed; i++)
+			pending.emplace_back(i, i + 1);
+
+		for (size_t depth = 0; depth < max_depth && !pending.empty(); depth++)
+		{
+			size_t i0 = x.size();
+			for (auto [a, b] : pending)
+				x.push_back(0.5 * (x[a] + x[b]));
+			evaluate(i0);
+
+			next.clear();
+			for (size_t k = 0; k < pending.size(); k++)
+			{
+				auto [a, b] = pending[k];
+				size_t m = i0 + k;
+				double error = 0;
+				for (size_t l = 0; l < lines; l++)
+				{
+					double e = std::fabs(v[m][l] - 0.5 * (v[a][l] + v[b][l]));
+					if (e > error) // NaN is not an error of the interpolation
+						error = e;
+				}
+				if (error > r.tol)
+				{
+					next.emplace_back(a, m);
+					next.emplace_back(m, b);
+				}
+			}
+			pending.swap(next);
+		}
+
+		std::sort(x.begin(), x.end());
+		return x;
+	}
+
+	/**
+	 * \brief Predictor of the next solution along a sweep axis.
+	 *
+	 * The last three solved points are extrapolated to the next abscissa: the previous value
+	 * after one point, linearly after two and quadratically after three. The returned bracket is
+	 * centred on the prediction, with a half width from the disagreement between the
+	 * extrapolation orders.
+	 **/
+	struct continuation
+	{
+		double x[3]; ///< abscissae of the last points, most recent first
+		double y[3]; ///< solutions of the last points, most recent first
+		size_t n = 0; ///< number of points retained
+
+		/**
+		 * \brief retain a solved point
+		 **/
+		void
+		push(double xi, double yi)
+		{
+			x[2] = x[1]; y[2] = y[1];
+			x[1] = x[0]; y[1] = y[0];
+			x[0] = xi; y[0] = yi;
+			n = std::min<size_t>(n + 1, 3);
+		}
+
+		/**
+		 * \brief predict the bracket of the solution at xi
+		 * \returns the bracket, or nothing until a point is retained
+		 **/
+		std::optional<opt::bracket>
+		seed(double xi) const
+		{
+			if (n == 0)
+				return std::nullopt;
+
+			double p0 = y[0];
+			double p1 = (n > 1) ? y[0] + (y[0] - y[1]) * (xi - x[0]) / (x[0] - x[1]) : p0;
+			double p2 = p1;
+			if (n > 2)
+			{
+				// Lagrange interpolant through the last three points
+				double l0 = (xi - x[1]) * (xi - x[2]) / ((x[0] - x[1]) * (x[0] - x[2]));
+				double l1 = (xi - x[0]) * (xi - x[2]) / ((x[1] - x[0]) * (x[1] - x[2]));
+				double l2 = (xi - x[0]) * (xi - x[1]) / ((x[2] - x[0]) * (x[2] - x[1]));
+				p2 = y[0] * l0 + y[1] * l1 + y[2] * l2;
+			}
+
+			double prediction = (n > 2) ? p2 : p1;
+			double error = (n > 2) ? std::fabs(p2 - p1) : std::fabs(p1 - p0);
+			double delta = std::max(2 * error, (n > 1) ? 1e-6 : 1e-2);
+
+			return opt::bracket{prediction - delta, prediction + delta};
+		}
+	};
+
+	/**
+	 * \brief Solve a sweep by continuation along the width axis.
+	 *
+	 * The sweep is split into lines of fixed wavelength, gap and mode order, and each line
+	 * into chunks of consecutive widths. Chunks are solved in parallel; within a chunk the widths are
+	 * solved in order, each seeded by the continuation of the previous widths of the chunk.
+	 * The table is indexed by the flat sweep index, as solve_sweep.
+	 *
+	 * \param s the sweep
+	 * \param table storage for the results, resized to s.size()
+	 * \param f callable that solves a point from a seed, double f(const point&, const std::optional<opt::bracket>&)
+	 * \param chunk number of consecutive widths solved by continuation
+	 **/
+	template<typename F>
+	void
+	solve_sweep_continuation(const sweep& s, std::vector<double>& table, F&& f, size_t chunk = 64)
+	{
+		table.resize(s.size());
+
+		const size_t J = std::max<size_t>(s.mode_orders.size(), 1);
+		const size_t W = std::max<size_t>(s.widths.size(), 1);
+		const size_t chunks = (W + chunk - 1) / chunk;
+
+		// Lines are the sweep with the width axis removed, in the order wavelength, gap, mode order
+		std::vector<size_t> tasks(s.size() / W * chunks);
+		std::iota(tasks.begin(), tasks.end(), 0);
+
+		auto solve_chunk = [&](const size_t& t)
+		{
+			size_t line = t / chunks;
+			size_t c = t % chunks;
+			size_t j = line % J;
+			size_t outer = line / J; // wavelength and gap
+
+			continuation predictor;
+			for (size_t w = c * chunk; w < std::min(W, (c + 1) * chunk); w++)
+			{
+				size_t i = (outer * W + w) * J + j;
+				auto p = s[i];
+				table[i] = f(p, predictor.seed(p.width));
+				predictor.push(p.width, table[i]);
+			}
+		};
+
+		#if PARALLEL
+			std::for_each(std::execution::par, tasks.begin(), tasks.end(), solve_chunk);
+		#else
+			std::for_each(tasks.begin(), tasks.end(), solve_chunk);
+		#endif
+	}
+
+}//namespace eim
+
+#endif //__SWEEP_H__
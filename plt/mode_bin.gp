@@ -0,0 +1,35 @@
+set term png size 800,600 enhanced font "Times New Roman,15"
+
+# Binary grid records, see inc/grid.h
+ifile="mode2D.bin"
+ofile="mode2D.png"
+record="0"
+pts="200"
+extent="1"
+element="0"
+
+# A record is a 128 byte header, two axes of pts doubles, then the pts x pts field
+N = pts + 0
+E = extent + 0.0
+bytes = (element + 0 == 0) ? 16 : 8
+fmt = (element + 0 == 0) ? "%double%double" : "%float%float"
+size = 128 + 16 * N + bytes * N * N
+skip = (record + 0) * size + 128 + 16 * N
+h = 2.0 * E / (N - 1)
+
+set output ofile
+set palette rgbformulae 34,35,36
+
+# Plot settings
+set xlabel "X (um)"
+set ylabel "Y (um)"
+set size ratio -1
+
+set pm3d map
+set view map
+set autoscale fix
+
+# Rows are the transverse axis, stored row-major
+splot ifile binary skip=skip array=(N,N) format=fmt transpose \
+	origin=(-E, -E, 0) dx=h dy=h \
+	using (sqrt($1**2 + $2**2)) with image notitle
@@ -23,13 +23,29 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <bit>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <numeric>
+#include <getopt.h>
+#include <sstream>
+#include <unordered_set>
 #include <log.h>
+#include <grid.h>
 #include <eim.h>
 #include <ctl.h>
 #include <strip.h>
 #include <slot.h>
+#include <sweep.h>
+#include <batch.h>
+#include <stats.h>
+#include <serve.h>
+#include <lut.h>
+#include <kernel.h>
+#include <inverse.h>
+#include <shard.h>
+#include <store.h>
 
 using namespace std;
 using namespace eim;
@@ -40,29 +56,103 @@ const char* usage =
 	"\t-t <type>               Waveguide type: 'strip' or 'slot'\n"
 	"\t-r <thickness>          Rib/core thickness\n"
 	"\t-s <thickness>          Slab thickness\n"
-	"\t-w <width>[,...]        Rib/core width(s)\n"
-	"\t-S <width>              Slot width\n"
+	"\t-w <width>[,...]        Rib/core width(s), or a range lo:hi:n, or lo:hi:adaptive[,tol=<tol>], or @<file> of values\n"
+	"\t-S <width>[,...]        Slot width(s), or @<file> of values\n"
 	"\t-n <n_box>,<n_core>,<n_clad>[,<n_slot>] Refractive indices\n"
 	"\t-m <mode>               Mode polarization: 'TE' or 'TM'.\n"
 	"\t-j <order>[,...]        Mode order(s): 0,1,2,...\n"
-	"\t-l <wavelength>[,...]   Wavelength\n"
+	"\t-l <wavelength>[,...]   Wavelength(s), or a range as for -w\n"
+	"\t-c                      Solve width sweeps by continuation\n"
+	"\t-N <neff>[,...]|cutoff  Solve for the unknown that gives each neff, or the cutoff of the mode\n"
+	"\t-x <unknown>            Unknown of -N over the range of its values: 'width', 'gap' or 'wavelength'\n"
+	"\t-b <file>               Solve the jobs of a file, one set of options per line, '-' for stdin\n"
+	"\t--cache <file>          Answer the points solved before from a persistent cache, and add the others\n"
+	"\t--serve[=<socket>]      Answer binary requests (inc/serve.h) on stdin/stdout, or a Unix socket\n"
+	"\t--shard <i>/<N>         Solve the i-th of N blocks of the sweep, and write it as a binary shard (inc/shard.h)\n"
+	"\t--merge <shard>...      Write the neff table of the shards of a sweep, in the order of the sweep\n"
 	"\nOutput Control:\n"
 	"\t-O                      Enable 2D mode field calculation\n"
 	"\t-o <filename>           Output filename for mode field\n"
+	"\t-f <format>             Mode field format: 'csv', 'bin', or 'csv32' and 'bin32' in single precision\n"
 	"\t-e <extent>             Spatial extent for field calculation\n"
-	"\t-p <points>             Number of points per axis\n";
+	"\t-p <points>             Number of points per axis\n"
+	"\t-F <output>[,...]       Columns of the csv mode field: amplitude, E, H, normal, intensity, phase\n"
+	"\t-g                      Write the group index and dispersion (ps/(nm km)) with each neff\n"
+	"\t-C                      Write the confinement factor of the core (and the slot) with each neff\n"
+	"\t--odd                   Write the neff of the odd mode of the slot with each neff\n"
+	"\t-L <filename>           Build a neff table over the range of the widths and wavelengths\n"
+	"\t-T <tol>                Absolute error of the neff table, 1e-6 by default\n"
+	"\t-i <stats>              Solver statistics: 'summary' at exit, 'rows' with each neff, or 'all'\n";
 
-int main(int argc, char* argv[])
+/**
+ * \brief label of a mode, e.g. TE0
+ */
+static string
+mode_label(Mode mode, unsigned order)
 {
-	std::unique_ptr<ctl> ctx = std::make_unique<ctl>(); //Application Control struct
+	return (mode == TE ? "TE" : "TM") + to_string(order);
+}
 
+/**
+ * \brief Parse the options of the command line, or of a job, into ctx
+ * \returns 0, or -1 if the options are invalid
+ */
+static int
+parse(int argc, char* argv[], ctl* ctx)
+{
+	optind = 0; // The options of every job are scanned from the start
 	try // Parsing command line
 	{
+		enum { SERVE = 256, SHARD, MERGE, CACHE, ODD };
+		static const option long_options[] = {
+			{"serve", optional_argument, NULL, SERVE},
+			{"shard", required_argument, NULL, SHARD},
+			{"merge", no_argument, NULL, MERGE},
+			{"cache", required_argument, NULL, CACHE},
+			{"odd", no_argument, NULL, ODD},
+			{"outputs", required_argument, NULL, 'F'},
+			{NULL, 0, NULL, 0}
+		};
+
 		int c;
-		while ((c = getopt(argc, argv, "e:j:hl:m:n:o:Op:r:s:S:t:w:")) != -1) 
+		while ((c = getopt_long(argc, argv, "b:cCe:f:F:gi:j:hl:L:m:n:N:o:Op:r:s:S:t:T:w:x:", long_options, NULL)) != -1) 
 		{
 			switch (c) 
 			{
+				case SERVE:
+				{
+					ctx->serve = true;
+					ctx->serve_socket = optarg;
+					break;
+				}
+				case SHARD:
+				{
+					size_t index, count;
+					char end;
+					if (sscanf(optarg, "%zu/%zu%c", &index, &count, &end) != 2 || index >= count)
+					{
+						cerr << "[ERROR] shard: must be <i>/<N>, with 0 <= i < N." << endl;
+						return -1;
+					}
+					ctx->shard_index = index;
+					ctx->shard_count = count;
+					break;
+				}
+				case MERGE:
+				{
+					ctx->merge = true;
+					break;
+				}
+				case CACHE:
+				{
+					ctx->cache = optarg;
+					break;
+				}
+				case ODD:
+				{
+					ctx->odd_modes = true;
+					break;
+				}
 				case 't':
 				{
 					string device{optarg};
@@ -81,11 +171,69 @@ int main(int argc, char* argv[])
 					}
 					break;
 				}
+				case 'b':
+				{
+					ctx->batch = optarg;
+					break;
+				}
+				case 'c':
+				{
+					ctx->continuation = true;
+					break;
+				}
+				case 'C':
+				{
+					ctx->confinement = true;
+					break;
+				}
 				case 'e':
 				{
 					ctx->extent = stod(optarg);
 					break;
 				}
+				case 'f':
+				{
+					string format{optarg};
+					if (format == "csv" || format == "csv32")
+					{
+						ctx->mode_binary = false;
+						ctx->mode_element = (format == "csv") ? COMPLEX_DOUBLE : COMPLEX_FLOAT;
+					}
+					else if (format == "bin" || format == "bin32")
+					{
+						ctx->mode_binary = true;
+						ctx->mode_element = (format == "bin") ? COMPLEX_DOUBLE : COMPLEX_FLOAT;
+					}
+					else
+					{
+						cerr << "[ERROR] format: must be 'csv', 'csv32', 'bin' or 'bin32'." << endl;
+						return -1;
+					}
+					break;
+				}
+				case 'F':
+				{
+					ctx->mode_outputs = parse_outputs(optarg);
+					break;
+				}
+				case 'g':
+				{
+					ctx->dispersion = true;
+					break;
+				}
+				case 'i':
+				{
+					string stats{optarg};
+					if (stats != "summary" && stats != "rows" && stats != "all")
+					{
+						cerr << "[ERROR] stats: must be 'summary', 'rows' or 'all'." << endl;
+						return -1;
+					}
+					ctx->stats_summary = (stats != "rows");
+					ctx->stats_rows = (stats != "summary");
+					stats::enabled = true;
+					break;
+				}
 				case 'j':
 				{
 					parse_numeric<unsigned>(optarg, ctx->mode_orders);
@@ -93,7 +241,17 @@ int main(int argc, char* argv[])
 				}
 				case 'l':
 				{
-					parse_numeric<double>(optarg, ctx->wavelengths);
+					parse_axis(optarg, ctx->wavelengths, ctx->adaptive_wavelengths);
+					break;
+				}
+				case 'L':
+				{
+					ctx->lut_logname = optarg;
+					break;
+				}
+				case 'T':
+				{
+					ctx->lut_tol = stod(optarg);
 					break;
 				}
 				case 'm':
@@ -156,6 +314,30 @@ int main(int argc, char* argv[])
 					}
 					break;
 				}
+				case 'N':
+				{
+					if (string(optarg) == "cutoff")
+						ctx->targets = {cutoff};
+					else if (!parse_numeric<double>(optarg, ctx->targets, 1.0))
+						throw runtime_error(string("no target neff in ") + optarg);
+					break;
+				}
+				case 'x':
+				{
+					string str{optarg};
+					if (str == "width")
+						ctx->unknown = WIDTH;
+					else if (str == "gap")
+						ctx->unknown = GAP;
+					else if (str == "wavelength")
+						ctx->unknown = WAVELENGTH;
+					else
+					{
+						cerr << "[ERROR] unknown: must be 'width', 'gap' or 'wavelength'." << endl;
+						return -1;
+					}
+					break;
+				}
 				case 'o':
 				{
 					ctx->mode_logname = optarg;
@@ -183,12 +365,12 @@ int main(int argc, char* argv[])
 				}
 				case 'S':
 				{
-					parse_numeric<double>(optarg, ctx->gaps);
+					parse_list(optarg, ctx->gaps);
 					break;
 				}
 				case 'w':
 				{
-					parse_numeric<double>(optarg, ctx->widths);
+					parse_axis(optarg, ctx->widths, ctx->adaptive_widths);
 					break;
 				}
 				case 'h':
@@ -204,6 +386,16 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
+	return 0;
+}
+
+/**
+ * \brief Validate the setup of ctx before it is solved
+ * \returns 0, or -1 if the setup is incomplete
+ */
+static int
+validate(ctl* ctx)
+{
 	try // validation
 	{
 		if (ctx->wavelengths.empty()) 
@@ -236,6 +428,12 @@ int main(int argc, char* argv[])
 			return -1;
 		}
 
+		if (!ctx->targets.empty() && ctx->unknown == GAP && ctx->device != Waveguide::SLOT)
+		{
+			cerr << "[ERROR] setup: The gap is only an unknown of slot waveguides" << endl;
+			return -1;
+		}
+
 		if (ctx->device == SLOT && ctx->gaps.empty()) 
 		{
 			cerr << "[ERROR] setup: Must specify at least one slot width" << endl;
@@ -248,6 +446,25 @@ int main(int argc, char* argv[])
 			return -1;
 		}
 
+		if(ctx->shard_count && (ctx->continuation || ctx->dispersion || ctx->confinement || ctx->stats_rows ||
+			ctx->mode_log || ctx->lut_logname || !ctx->targets.empty()))
+		{
+			cerr << "[ERROR] setup: a shard holds the neff of its points only, without -c, -g, -C, -O, -L, -N or -i rows" << endl;
+			return -1;
+		}
+
+		if(ctx->odd_modes && (ctx->device != SLOT || ctx->shard_count || ctx->cache || ctx->lut_logname || !ctx->targets.empty()))
+		{
+			cerr << "[ERROR] setup: --odd is a column of the slot neff table, without --shard, --cache, -L or -N" << endl;
+			return -1;
+		}
+
+		if(ctx->cache && ctx->continuation)
+		{
+			cerr << "[ERROR] setup: the points of --cache are solved one by one, not by continuation (-c)" << endl;
+			return -1;
+		}
+
 		if(ctx->mode_log) 
 		{
 			if(!ctx->pts)
@@ -260,6 +477,16 @@ int main(int argc, char* argv[])
 				cerr << "[ERROR] setup: Must set mode extent" << endl;
 				return -1;	
 			}
+			if(ctx->mode_binary && ctx->mode_outputs != AMPLITUDE)
+			{
+				cerr << "[ERROR] setup: the binary mode output is the complex field, -F applies to csv" << endl;
+				return -1;
+			}
+			if(ctx->device == SLOT && (ctx->mode_outputs & (E_FIELD | H_FIELD | NORMAL)))
+			{
+				cerr << "[ERROR] setup: the slot mode output has the transverse field only: amplitude, intensity, phase" << endl;
+				return -1;
+			}
 
 		}
 
@@ -270,142 +497,993 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	try // Running the program
+	return 0;
+}
+
+/**
+ * \brief Build the neff table of ctx over the range of its widths and wavelengths, and write it
+ * \param f callable neff f(width, wavelength) of the first mode order
+ * \throws std::exception if the range is empty or the table cannot be written
+ */
+template<typename F>
+static void
+write_lut(ctl* ctx, F&& f)
+{
+	auto [w0, w1] = ranges::minmax(ctx->widths);
+	auto [l0, l1] = ranges::minmax(ctx->wavelengths);
+
+	lut_header h;
+	h.w0 = w0; h.w1 = w1;
+	h.l0 = l0; h.l1 = l1;
+	h.tol = ctx->lut_tol;
+	h.t_slab = ctx->t_slab;
+	h.t_rib = ctx->t_core;
+	h.mode = ctx->mode;
+	h.mode_order = ctx->mode_orders[0];
+
+	auto lut = neff_lut::build(f, h);
+	lut.save(ctx->lut_logname);
+	cerr << "[INFO] lut: " << ctx->lut_logname << ": " << lut.h.leaves << " leaves, error " << lut.h.error << endl;
+}
+
+/**
+ * \brief set a waveguide to the point p of a sweep
+ */
+static void
+place(Strip& wg, const point& p)
+{
+	wg.wavelength = p.wavelength;
+	wg.w_rib = p.width;
+	wg.mode_order = p.mode_order;
+}
+
+static void
+place(waveguide& wg, const point& p)
+{
+	wg.wavelength = p.wavelength;
+	wg.w_core = p.width;
+	wg.w_slot = p.gap;
+	wg.mode_order = p.mode_order;
+}
+
+/**
+ * \brief record the geometry of a waveguide in the header of a field
+ */
+static void
+describe(const Strip& wg, grid_header* h)
+{
+	h->t_slab = wg.t_slab;
+	h->t_rib = wg.t_rib;
+	h->width = wg.w_rib;
+}
+
+static void
+describe(const waveguide& wg, grid_header* h)
+{
+	h->t_rib = wg.t_core;
+	h->width = wg.w_core;
+	h->gap = wg.w_slot;
+}
+
+/**
+ * \returns the geometry columns of the csv field output, and their values for wg
+ */
+static array<string, 3>
+geometry(const Strip& wg, bool names = false)
+{
+	if (names)
+		return {"t_slab", "t_rib", "width"};
+	return {to_string(wg.t_slab), to_string(wg.t_rib), to_string(wg.w_rib)};
+}
+
+static array<string, 3>
+geometry(const waveguide& wg, bool names = false)
+{
+	if (names)
+		return {"t_core", "w_core", "w_slot"};
+	return {to_string(wg.t_core), to_string(wg.w_core), to_string(wg.w_slot)};
+}
+
+/**
+ * \brief Calculate the mode field of every point of a sweep, and write them
+ * \param wg the waveguide; wavelength, width, gap and mode order are taken from the sweep
+ * \param s the sweep
+ * \param neff the effective refractive indices of the sweep, which the fields are calculated from
+ */
+template<typename WG>
+static void
+write_fields(ctl* ctx, WG wg, const sweep& s, const vector<double>& neff)
+{
+	constexpr bool strip = is_same_v<WG, Strip>;
+	stats::timer t(stats::OUTPUT);
+	if (!ctx->mode_logname)
 	{
-		if (ctx->device == Waveguide::STRIP)
-		{
-			Strip wg{
-				.wavelength = ctx->wavelengths[0],
-				.t_rib = ctx->t_core,
-				.t_slab = ctx->t_slab,
-				.w_rib = ctx->widths[0],
-				.w_slab = 0, // Not used in EIM
-				.n_box = ctx->n_box,
-				.n_core = ctx->n_core,
-				.n_clad = ctx->n_clad,
-				.mode_order = ctx->mode_orders[0],
-				.mode = ctx->mode
-			};
+		if (strip)
+			ctx->mode_logname = ctx->mode_binary ? "mode2D_strip.bin" : "mode2D_strip.csv";
+		else
+			ctx->mode_logname = ctx->mode_binary ? "mode2D_slot.bin" : "mode2D_slot.csv";
+	}
 
-			printf("t_slab,t_rib,width,wavelength,mode,neff\n");
+	cvector<double> x(ctx->pts);
+	vec::linspace(x.begin(), x.end(), -ctx->extent, ctx->extent);
 
-			// Calculate neff for each width and mode order
-			for(const auto& l : ctx->wavelengths)
+	if (ctx->mode_binary)
+	{
+		grid_header h;
+		h.element = ctx->mode_element;
+		h.rows = h.cols = ctx->pts;
+		describe(wg, &h);
+		h.mode = wg.mode;
+		grid_file mode2D(ctx->mode_logname, h, s.size(), x.data(), x.data());
+
+		// Fields are calculated in place in the mapped file
+
+		for (size_t i = 0; i < s.size(); i++)
+		{
+			place(wg, s[i]);
+
+			auto r = mode2D[i];
+			describe(wg, r.header());
+			r.header()->wavelength = wg.wavelength;
+			r.header()->neff = neff[i];
+			r.header()->mode_order = wg.mode_order;
+
+			// The profiles of a bin32 record are evaluated, and multiplied out, in single precision
+			if (ctx->mode_element == COMPLEX_DOUBLE)
+				wg.mode_field(x, neff[i], scratch_field()).materialize(r.field<field_t>(), ctx->pts);
+			else
+				wg.mode_field(x, neff[i], scratch_field<complex<float>>()).materialize(r.field<complex<float>>(), ctx->pts);
+		}
+	}
+	else
+	{
+		Log mode2D(ctx->mode_logname, ",");
+		for (const auto& column : geometry(wg, true))
+			mode2D << column;
+		mode2D << "mode" << "transverse" << "lateral";
+		for (size_t k = 0; k < size(output_names); k++)
+			if (ctx->mode_outputs & (1 << k))
+				mode2D << output_names[k];
+		++mode2D;
+
+		// Each column is read from the field of one component of the lateral profile, and only
+		// the components of the columns are evaluated. E and H are the transverse and lateral
+		// components of the lateral analysis, which is TM for a TE mode and TE for a TM mode.
+		auto source = [&wg](Output o)
+		{
+			switch (o)
 			{
-				wg.wavelength = l;
-				for (const auto& w : ctx->widths)
-				{
-					wg.w_rib = w;
-					for (const auto& j : ctx->mode_orders)
-					{
-						wg.mode_order = j;
-						printf("%.3g,%.3g,%.3g,%.4g,%s%lu,%.6g\n",
-							wg.t_slab, 
-							wg.t_rib, 
-							wg.w_rib,
-							wg.wavelength, 
-							wg.mode == TE ? "TE" : "TM",
-							wg.mode_order, 
-							wg());
-					}
-				}
+				case E_FIELD: return (wg.mode == TE) ? LATERAL_FIELD : TRANSVERSE_FIELD;
+				case H_FIELD: return (wg.mode == TE) ? TRANSVERSE_FIELD : LATERAL_FIELD;
+				case NORMAL: return NORMAL_FIELD;
+				default: return TRANSVERSE_FIELD;
 			}
-
-			// Mode field calculation
-			if (ctx->mode_log)
+		};
+		vector<pair<Output, size_t>> columns;
+		uint8_t components = 0;
+		for (size_t k = 0; k < size(output_names); k++)
+			if (ctx->mode_outputs & (1 << k))
 			{
-				if (!ctx->mode_logname)
-					ctx->mode_logname = "mode2D_strip.csv";
+				Component c = source(Output(1 << k));
+				columns.push_back({Output(1 << k), countr_zero(unsigned(c))});
+				components |= c;
+			}
 
-				Log mode2D(ctx->mode_logname, ",");
-				mode2D << "t_slab" << "t_rib" << "width" << "mode" 
-					   << "transverse" << "lateral" << "amplitude";
-				++mode2D;
+		// The fields of csv32 are evaluated in single precision, which is ample for the 6 digits of the text
+		auto write_csv = [&]<typename T>()
+		{
+			// The fields are streamed a row at a time from their 1D profiles
+			array<separable_field<T>, 3> fields;
+			array<vector<T>, 3> rows;
+			for (auto& row : rows)
+				row.resize(ctx->pts);
 
-				cvector<double> x(ctx->pts);
-				vec::linspace(x.begin(), x.end(), -ctx->extent, ctx->extent);
-				cmatrix<field_t> field(ctx->pts, ctx->pts);
+			// The coordinates are formatted once, rather than on every row
+			vector<string> xs(ctx->pts);
+			for (size_t i = 0; i < ctx->pts; ++i)
+			{
+				char buf[32];
+				auto end = to_chars(buf, buf + sizeof(buf), x[i], chars_format::fixed, 6).ptr;
+				xs[i].assign(buf, end);
+			}
 
-				auto log_mode = [&]()
-				{
-					wg.mode_2D(x, field);
-					for (size_t i = 0; i < ctx->pts; ++i) 
+			auto log_mode = [&](double n)
+			{
+				for (size_t c = 0; c < 3; c++)
+					if (components & (1 << c))
 					{
-						for (size_t j = 0; j < ctx->pts; ++j)
-						{
-							mode2D << wg.t_slab << wg.t_rib << wg.w_rib
-								   << ((wg.mode == TE ? "TE" : "TM") + to_string(wg.mode_order))
-								   << x[i] << x[j] << abs(field[i][j]);
-							++mode2D;
-						}
+						if constexpr (strip)
+							wg.mode_field(x, n, fields[c], Component(1 << c));
+						else
+							wg.mode_field(x, n, fields[c]);
 					}
-				};
 
-				// Calculate fields for all width/mode combinations
-				for(const auto& l : ctx->wavelengths)
+				// The columns that are constant over the field are formatted once
+				auto g = geometry(wg);
+				string prefix = g[0] + "," + g[1] + "," + g[2] + "," + mode_label(wg.mode, wg.mode_order);
+				for (size_t i = 0; i < ctx->pts; ++i) 
 				{
-					wg.wavelength = l;
-					for (const auto& w : ctx->widths)
+					for (size_t c = 0; c < 3; c++)
+						if (components & (1 << c))
+							fields[c].row(i, rows[c].data());
+					for (size_t j = 0; j < ctx->pts; ++j)
 					{
-						wg.w_rib = w;
-						for (const auto& j : ctx->mode_orders)
+						mode2D << prefix << xs[i] << xs[j];
+						for (auto [o, c] : columns)
 						{
-							wg.mode_order = j;
-							log_mode();
+							T a = rows[c][j];
+							if (o == INTENSITY)
+								mode2D << norm(a);
+							else if (o == PHASE)
+								mode2D << arg(a);
+							else
+								mode2D << abs(a);
 						}
+						++mode2D;
 					}
 				}
+			};
+
+			// Calculate fields for all width/mode combinations
+			for (size_t i = 0; i < s.size(); i++)
+			{
+				place(wg, s[i]);
+				log_mode(neff[i]);
 			}
+		};
+
+		if (ctx->mode_element == COMPLEX_DOUBLE)
+			write_csv.template operator()<field_t>();
+		else
+			write_csv.template operator()<complex<float>>();
+	}
+}
+
+/**
+ * \brief Solve the points of a sweep that the persistent cache of ctx does not hold, and add them to it
+ * \param device the waveguide type
+ * \param m the material stack, as of the kernel of the sweep
+ * \param t_core thickness of the rib/core layer
+ * \param t_slab thickness of the slab layer, 0 for a slot
+ * \param neff the effective refractive indices, indexed as the sweep
+ * \param solve callable that solves a point missing from the cache, double solve(const point&)
+ */
+template<typename F>
+static void
+solve_cached(ctl* ctx, Waveguide device, const stack& m, double t_core, double t_slab,
+	const sweep& s, vector<double>& neff, F&& solve)
+{
+	neff_store store(ctx->cache, s.size());
+	atomic<size_t> hits = 0;
+	solve_sweep(s, neff, [&](const point& p)
+	{
+		store_key key{
+			.device = device,
+			.mode = ctx->mode,
+			.mode_order = p.mode_order,
+			.wavelength = p.wavelength,
+			.width = p.width,
+			.gap = p.gap,
+			.t_core = t_core,
+			.t_slab = t_slab,
+			.n_box = m.n_box,
+			.n_core = m.n_core,
+			.n_clad = m.n_clad,
+			.n_slot = (device == SLOT) ? m.n_slot : 0
+		};
+		if (auto n = store.find(key))
+		{
+			hits.fetch_add(1, memory_order_relaxed);
+			return *n;
 		}
-		else // SLOT waveguide
-		{
-			waveguide wg{
-				.wavelength = ctx->wavelengths[0],
-				.t_core = ctx->t_core,
-				.w_core = ctx->widths[0],
-				.w_slot = ctx->gaps[0],
-				.n_box = ctx->n_box,
-				.n_clad = ctx->n_clad,
-				.n_core = ctx->n_core,
-				.n_slot = ctx->n_slot,
-				.mode_order = ctx->mode_orders[0],
-				.mode = ctx->mode
-			};
+		double n = solve(p);
+		store.insert(key, n);
+		return n;
+	});
+	cerr << "[INFO] cache: " << ctx->cache << ": " << hits << " of " << s.size() << " points, " << store.count() << " stored" << endl;
+}
+
+/**
+ * \brief Solve the shard of ctx of a sweep, and write it in the shard format
+ * \param s the sweep of all the shards; the shard is its block of flat indices, from shard_range
+ * \param output the stream of the shard
+ */
+template<typename WG>
+static void
+solve_shard(ctl* ctx, const sweep& s, FILE* output)
+{
+	constexpr bool strip = is_same_v<WG, Strip>;
+	auto [first, last] = shard_range(s.size(), ctx->shard_index, ctx->shard_count);
 
-			printf("t_core,w_core,w_slot,wavelength,mode,neff\n");
+	shard_file f;
+	f.h.device = strip ? STRIP : SLOT;
+	f.h.index = ctx->shard_index;
+	f.h.count = ctx->shard_count;
+	f.h.total = s.size();
+	f.h.first = first;
+	f.h.points = last - first;
+	f.h.digest = sweep_digest(s);
+	f.h.t_slab = strip ? ctx->t_slab : 0;
+	f.h.t_core = ctx->t_core;
+	f.h.n_box = ctx->n_box;
+	f.h.n_core = ctx->n_core;
+	f.h.n_clad = ctx->n_clad;
+	f.h.n_slot = strip ? 0 : ctx->n_slot;
+	f.h.mode = ctx->mode;
+	f.h.width_digits = ctx->adaptive_widths ? 6 : 3;
+	f.h.wavelength_digits = ctx->adaptive_wavelengths ? 6 : 4;
 
-			// Calculate neff for each width, gap and mode order
-			for(const auto& l : ctx->wavelengths)
+	// The points of the shard are solved in parallel within the node, by the kernel of the sweep
+	vector<double> neff;
+	stack m{ctx->n_box, ctx->n_core, ctx->n_clad, strip ? ctx->n_clad : ctx->n_slot};
+	with_kernel<strip ? STRIP : SLOT>(ctx->mode, m, ctx->t_core, f.h.t_slab, [&](const auto& k)
+	{
+		solve_sweep(s, first, last, neff, [&k](const point& p) { return k(p); });
+	});
+
+	stats::timer t(stats::OUTPUT);
+	f.records.resize(neff.size());
+	for (size_t i = 0; i < neff.size(); i++)
+	{
+		auto p = s[first + i];
+		f.records[i] = {p.wavelength, p.gap, p.width, neff[i], p.mode_order};
+	}
+	f.save(output);
+}
+
+/**
+ * \brief Write the neff table of the shards of a sweep, as the table of the sweep solved on one node
+ * \param paths the shard files, in any order
+ * \param output the stream of the table
+ * \throws std::runtime_error if the shards do not make up one sweep
+ */
+static void
+write_merge(const vector<string>& paths, FILE* output)
+{
+	shard_header h;
+	auto records = merge_shards(paths, h);
+
+	Log out(output, ",");
+	if (h.device == STRIP)
+		out << "t_slab" << "t_rib" << "width";
+	else
+		out << "t_core" << "w_core" << "w_slot";
+	out << "wavelength" << "mode" << "neff";
+	++out;
+	for (const auto& r : records)
+	{
+		if (h.device == STRIP)
+			out << Log::general(h.t_slab, 3) << Log::general(h.t_core, 3) << Log::general(r.width, h.width_digits);
+		else
+			out << Log::general(h.t_core, 3) << Log::general(r.width, h.width_digits) << Log::general(r.gap, 3);
+		out << Log::general(r.wavelength, h.wavelength_digits)
+			<< mode_label(Mode(h.mode), r.mode_order)
+			<< Log::general(r.neff, 6);
+		++out;
+	}
+	out.flush();
+}
+
+/**
+ * \brief Solve the unknown of ctx for each of its targets, over the range of the values of the unknown, and write them
+ * \param wg the waveguide; the other parameters are swept as their values
+ * \param output the stream of the table, of the neff table with the unknown solved
+ * \throws std::exception if the range of the unknown is empty
+ */
+template<typename WG>
+static void
+write_inverse(ctl* ctx, WG wg, const sweep& all, FILE* output)
+{
+	constexpr bool strip = is_same_v<WG, Strip>;
+	const Axis axis = ctx->unknown;
+	const auto& values = (axis == WAVELENGTH) ? ctx->wavelengths : (axis == GAP) ? ctx->gaps : ctx->widths;
+	auto [lo, hi] = ranges::minmax(values);
+	if (!(lo < hi))
+		throw runtime_error("inverse: the unknown must be given the two ends of its range");
+
+	// The unknown is removed from the sweep
+	sweep s = all;
+	if (axis == WAVELENGTH)
+		s.wavelengths = {};
+	else if (axis == GAP)
+		s.gaps = {};
+	else
+		s.widths = {};
+
+	vector<double> x;
+	solve_inverse(s, axis, lo, hi, ctx->targets,
+		[&wg](const point& p) { WG pt = wg; place(pt, p); return pt(); },
+		[&wg](const point& p) { WG pt = wg; place(pt, p); return pt.cladding_index(); },
+		x);
+
+	stats::timer t(stats::OUTPUT);
+	auto digits = [axis](Axis a, int n) { return (a == axis) ? 9 : n; };
+	Log out(output, ",");
+	if (strip)
+		out << "t_slab" << "t_rib" << "width";
+	else
+		out << "t_core" << "w_core" << "w_slot";
+	out << "wavelength" << "mode" << "neff";
+	++out;
+
+	const size_t T = ctx->targets.size();
+	for (size_t k = 0; k < x.size(); k++)
+	{
+		point p = s[k / T];
+		set(p, axis, x[k]);
+		place(wg, p);
+
+		// The neff of a cutoff is the index of the outer regions there
+		double neff = ctx->targets[k % T];
+		if (isnan(neff) && !isnan(x[k]))
+			neff = wg.cladding_index();
+
+		if constexpr (strip)
+			out << Log::general(wg.t_slab, 3) << Log::general(wg.t_rib, 3) << Log::general(p.width, digits(WIDTH, 3));
+		else
+			out << Log::general(wg.t_core, 3) << Log::general(p.width, digits(WIDTH, 3)) << Log::general(p.gap, digits(GAP, 3));
+		out << Log::general(p.wavelength, digits(WAVELENGTH, 4))
+			<< mode_label(wg.mode, p.mode_order)
+			<< Log::general(neff, 6);
+		++out;
+	}
+	out.flush();
+}
+
+/**
+ * \brief Sample the adaptive ranges of ctx, replacing the ends of their axes with the refined points
+ *
+ * The widths are refined over every line of the other axes, then the wavelengths over the refined widths.
+ * \param wg the waveguide; the swept parameters are taken from ctx
+ */
+template<typename WG>
+static void
+refine_axes(ctl* ctx, WG wg)
+{
+	constexpr bool strip = is_same_v<WG, Strip>;
+	auto refine_axis = [&](Axis axis, const adaptive_range& r, vector<double>& values, const char* name)
+	{
+		sweep lines{ctx->wavelengths, strip ? span<const double>{} : span<const double>{ctx->gaps}, ctx->widths, ctx->mode_orders};
+		if (axis == WAVELENGTH)
+			lines.wavelengths = {};
+		else
+			lines.widths = {};
+
+		auto points = refine(r, lines.size(), [&](double x, size_t l)
+		{
+			point p = lines[l];
+			set(p, axis, x);
+			WG pt = wg;
+			place(pt, p);
+			return pt();
+		});
+		values = std::move(points);
+		cerr << "[INFO] adaptive: " << name << ": " << values.size() << " points" << endl;
+	};
+
+	if (ctx->adaptive_widths)
+		refine_axis(WIDTH, *ctx->adaptive_widths, ctx->widths, "width");
+	if (ctx->adaptive_wavelengths)
+		refine_axis(WAVELENGTH, *ctx->adaptive_wavelengths, ctx->wavelengths, "wavelength");
+}
+
+/**
+ * \brief Solve the waveguide of ctx
+ * \param output the stream of the neff table
+ * \throws std::exception on failure of the calculation
+ */
+static void
+run(ctl* ctx, FILE* output)
+{
+	if (ctx->device == Waveguide::STRIP)
+	{
+		Strip wg{
+			.wavelength = ctx->wavelengths[0],
+			.t_rib = ctx->t_core,
+			.t_slab = ctx->t_slab,
+			.w_rib = ctx->widths[0],
+			.w_slab = 0, // Not used in EIM
+			.n_box = ctx->n_box,
+			.n_core = ctx->n_core,
+			.n_clad = ctx->n_clad,
+			.mode_order = ctx->mode_orders[0],
+			.mode = ctx->mode
+		};
+
+		if (ctx->lut_logname)
+		{
+			write_lut(ctx, [&wg](double width, double wavelength)
+			{
+				Strip pt = wg;
+				pt.w_rib = width;
+				pt.wavelength = wavelength;
+				return pt();
+			});
+			return;
+		}
+
+		if (ctx->targets.empty())
+			refine_axes(ctx, wg);
+
+		sweep s{ctx->wavelengths, {}, ctx->widths, ctx->mode_orders};
+
+		if (ctx->shard_count)
+		{
+			solve_shard<Strip>(ctx, s, output);
+			return;
+		}
+
+		if (!ctx->targets.empty())
+		{
+			write_inverse(ctx, wg, s, output);
+			return;
+		}
+
+		// Calculate neff for each wavelength, width and mode order
+		vector<double> neff;
+		vector<stats::tally> tallies(ctx->stats_rows ? s.size() : 0);
+
+		// The runs of each point are tallied for the rows of the statistics
+		auto tally = [&tallies](const point& p, auto&& f)
+		{
+			return tallies.empty() ? f() : stats::tallied(tallies[p.index], f);
+		};
+		stack m{wg.n_box, wg.n_core, wg.n_clad, wg.n_clad};
+
+		// The kernel of the mode and stack is chosen once for the sweep
+		if (ctx->cache)
+			with_kernel<STRIP>(wg.mode, m, wg.t_rib, wg.t_slab, [&](const auto& k)
 			{
-				wg.wavelength = l;
-				for (const auto& g: ctx->gaps)
+				solve_cached(ctx, STRIP, m, wg.t_rib, wg.t_slab, s, neff, [&](const point& p)
 				{
-					wg.w_slot = g;
-					for (const auto& w : ctx->widths)
+					return tally(p, [&]() { return k(p); });
+				});
+			});
+		else if (ctx->continuation)
+			with_kernel<STRIP>(wg.mode, m, wg.t_rib, wg.t_slab, [&](const auto& k)
+			{
+				solve_sweep_continuation(s, neff, [&](const point& p, const optional<opt::bracket>& seed)
+				{
+					return tally(p, [&]() { return k(p, seed); });
+				});
+			});
+		else if (ctx->mode_orders.size() > 1 && ranges::max(ctx->mode_orders) < max_modes)
+		{
+			// Every mode order of a wavelength and width is solved in one pass
+			sweep lines{ctx->wavelengths, {}, ctx->widths, {}};
+			vector<slab_modes> modes;
+			vector<stats::tally> line_tallies(tallies.empty() ? 0 : lines.size());
+			solve_sweep(lines, modes, [&wg, &line_tallies](const point& p)
+			{
+				Strip pt = wg;
+				pt.wavelength = p.wavelength;
+				pt.w_rib = p.width;
+				if (line_tallies.empty())
+					return pt.modes();
+				return stats::tallied(line_tallies[p.index], [&]() { return pt.modes(); });
+			});
+
+			const size_t J = ctx->mode_orders.size();
+			neff.resize(s.size());
+			for (size_t i = 0; i < s.size(); i++)
+				neff[i] = modes[i / J][ctx->mode_orders[i % J]];
+
+			// The orders of a line share its runs
+			for (size_t i = 0; i < tallies.size(); i++)
+				tallies[i] = line_tallies[i / J];
+		}
+		else if (!tallies.empty())
+			with_kernel<STRIP>(wg.mode, m, wg.t_rib, wg.t_slab, [&](const auto& k)
+			{
+				solve_sweep(s, neff, [&](const point& p) { return tally(p, [&]() { return k(p); }); });
+			});
+		else
+			solve_sweep(wg, s, neff);
+
+		// The derivatives of each root are differentiated from the root, without solving again
+		vector<ad::jet2> jets;
+		if (ctx->dispersion)
+			solve_sweep(s, jets, [&wg, &neff](const point& p)
+			{
+				Strip pt = wg;
+				pt.wavelength = p.wavelength;
+				pt.w_rib = p.width;
+				pt.mode_order = p.mode_order;
+				return pt.dispersion(neff[p.index]);
+			});
+
+		// The confinement of the rib core, from the closed form powers of the profiles
+		vector<double> gamma;
+		if (ctx->confinement)
+			solve_sweep(s, gamma, [&wg, &neff](const point& p)
+			{
+				Strip pt = wg;
+				place(pt, p);
+				return pt.power(neff[p.index]).fraction(1, 1);
+			});
+
+		{
+			stats::timer t(stats::OUTPUT);
+			Log out(output, ",");
+			out << "t_slab" << "t_rib" << "width" << "wavelength" << "mode" << "neff";
+			if (ctx->dispersion)
+				out << "ng" << "D";
+			if (ctx->confinement)
+				out << "confinement";
+			if (ctx->stats_rows)
+				out << "solves" << "iterations" << "evaluations" << "diverged" << "invalid_range";
+			++out;
+			for (size_t i = 0; i < s.size(); i++)
+			{
+				auto p = s[i];
+				out << Log::general(wg.t_slab, 3)
+					<< Log::general(wg.t_rib, 3)
+					<< Log::general(p.width, ctx->adaptive_widths ? 6 : 3)
+					<< Log::general(p.wavelength, ctx->adaptive_wavelengths ? 6 : 4)
+					<< mode_label(wg.mode, p.mode_order)
+					<< Log::general(neff[i], 6);
+				if (ctx->dispersion)
+					out << Log::general(group_index(jets[i], p.wavelength), 6)
+						<< Log::general(dispersion_D(jets[i], p.wavelength), 6);
+				if (ctx->confinement)
+					out << Log::general(gamma[i], 6);
+				if (ctx->stats_rows)
+					out << tallies[i].solves << tallies[i].iterations << tallies[i].evaluations
+						<< tallies[i].diverged << tallies[i].invalid_range;
+				++out;
+			}
+			out.flush();
+		}
+
+		// Mode field calculation
+		if (ctx->mode_log)
+			write_fields(ctx, wg, s, neff);
+	}
+	else // SLOT waveguide
+	{
+		waveguide wg{
+			.wavelength = ctx->wavelengths[0],
+			.t_core = ctx->t_core,
+			.w_core = ctx->widths[0],
+			.w_slot = ctx->gaps[0],
+			.n_box = ctx->n_box,
+			.n_clad = ctx->n_clad,
+			.n_core = ctx->n_core,
+			.n_slot = ctx->n_slot,
+			.mode_order = ctx->mode_orders[0],
+			.mode = ctx->mode
+		};
+
+		if (ctx->lut_logname)
+		{
+			write_lut(ctx, [&wg](double width, double wavelength)
+			{
+				waveguide pt = wg;
+				pt.w_core = width;
+				pt.wavelength = wavelength;
+				return pt();
+			});
+			return;
+		}
+
+		if (ctx->targets.empty())
+			refine_axes(ctx, wg);
+
+		sweep s{ctx->wavelengths, ctx->gaps, ctx->widths, ctx->mode_orders};
+
+		if (ctx->shard_count)
+		{
+			solve_shard<waveguide>(ctx, s, output);
+			return;
+		}
+
+		if (!ctx->targets.empty())
+		{
+			write_inverse(ctx, wg, s, output);
+			return;
+		}
+
+		// Calculate neff for each wavelength, gap, width and mode order
+		vector<stats::tally> tallies(ctx->stats_rows ? s.size() : 0);
+		auto tally = [&tallies](const point& p, auto&& f)
+		{
+			return tallies.empty() ? f() : stats::tallied(tallies[p.index], f);
+		};
+
+		// The kernel of the mode and stack is chosen once for the sweep
+		vector<double> neff, neff_odd;
+		stack m{wg.n_box, wg.n_core, wg.n_clad, wg.n_slot};
+		if (ctx->cache || ctx->continuation || !tallies.empty())
+			with_kernel<SLOT>(wg.mode, m, wg.t_core, 0, [&](const auto& k)
+			{
+				if (ctx->cache)
+					solve_cached(ctx, SLOT, m, wg.t_core, 0, s, neff, [&](const point& p)
 					{
-						wg.w_core = w;
-						for (const auto& j : ctx->mode_orders)
-						{
-							wg.mode_order = j;
-							printf("%.3g,%.3g,%.3g,%.4g,%s%lu,%.6g\n",
-								wg.t_core, 
-								wg.w_core, 
-								wg.w_slot,
-								wg.wavelength, 
-								wg.mode == TE ? "TE" : "TM",
-								wg.mode_order, 
-								wg());
-						}
+						return tally(p, [&]() { return k(p); });
+					});
+				else if (ctx->continuation)
+					solve_sweep_continuation(s, neff, [&](const point& p, const optional<opt::bracket>& seed)
+					{
+						return tally(p, [&]() { return k(p, seed); });
+					});
+				else
+					solve_sweep(s, neff, [&](const point& p) { return tally(p, [&]() { return k(p); }); });
+			});
+		else // the even and odd modes share the lanes of the batch
+			solve_sweep(wg, s, neff, ctx->odd_modes ? &neff_odd : nullptr);
+
+		if (ctx->odd_modes && neff_odd.empty())
+			solve_sweep(s, neff_odd, [&](const point& p)
+			{
+				waveguide pt = wg;
+				place(pt, p);
+				return tally(p, [&]() { return pt(nullopt, ODD_MODE); });
+			});
+
+		vector<ad::jet2> jets;
+		if (ctx->dispersion)
+			solve_sweep(s, jets, [&wg, &neff](const point& p)
+			{
+				waveguide pt = wg;
+				pt.wavelength = p.wavelength;
+				pt.w_slot = p.gap;
+				pt.w_core = p.width;
+				pt.mode_order = p.mode_order;
+				return pt.dispersion(neff[p.index]);
+			});
+
+		// The confinement of the slot and of the rails, from the closed form powers of the profiles
+		vector<array<double, 2>> gamma;
+		if (ctx->confinement)
+			solve_sweep(s, gamma, [&wg, &neff](const point& p)
+			{
+				waveguide pt = wg;
+				place(pt, p);
+				auto P = pt.power(neff[p.index]);
+				return array<double, 2>{P.fraction(2, 1), P.fraction(1, 1) + P.fraction(3, 1)};
+			});
+
+		{
+			stats::timer t(stats::OUTPUT);
+			Log out(output, ",");
+			out << "t_core" << "w_core" << "w_slot" << "wavelength" << "mode" << "neff";
+			if (ctx->odd_modes)
+				out << "neff_odd";
+			if (ctx->dispersion)
+				out << "ng" << "D";
+			if (ctx->confinement)
+				out << "confinement_slot" << "confinement_core";
+			if (ctx->stats_rows)
+				out << "solves" << "iterations" << "evaluations" << "diverged" << "invalid_range";
+			++out;
+			for (size_t i = 0; i < s.size(); i++)
+			{
+				auto p = s[i];
+				out << Log::general(wg.t_core, 3)
+					<< Log::general(p.width, ctx->adaptive_widths ? 6 : 3)
+					<< Log::general(p.gap, 3)
+					<< Log::general(p.wavelength, ctx->adaptive_wavelengths ? 6 : 4)
+					<< mode_label(wg.mode, p.mode_order)
+					<< Log::general(neff[i], 6);
+				if (ctx->odd_modes)
+					out << Log::general(neff_odd[i], 6);
+				if (ctx->dispersion)
+					out << Log::general(group_index(jets[i], p.wavelength), 6)
+						<< Log::general(dispersion_D(jets[i], p.wavelength), 6);
+				if (ctx->confinement)
+					out << Log::general(gamma[i][0], 6) << Log::general(gamma[i][1], 6);
+				if (ctx->stats_rows)
+					out << tallies[i].solves << tallies[i].iterations << tallies[i].evaluations
+						<< tallies[i].diverged << tallies[i].invalid_range;
+				++out;
+			}
+			out.flush();
+		}
+
+		// Mode field calculation
+		if (ctx->mode_log)
+			write_fields(ctx, wg, s, neff);
+	}
+}
+
+/**
+ * \brief A job of a batch, one line of the job file
+ */
+struct job
+{
+	size_t line;                ///< line of the job in the job file
+	std::vector<string> args;   ///< the options of the line, which the pointers of ctx refer to
+	ctl ctx;                    ///< the setup of the job
+	int status = 0;             ///< 0, or -1 if the job failed
+	std::string error = {};     ///< the error of a failed calculation
+	char* output = NULL;        ///< the neff table of the job
+	size_t size = 0;            ///< size of the neff table
+};
+
+/**
+ * \brief Solve the jobs of the job file of ctx
+ *
+ * Each line of the job file is a set of options, parsed as the command line on top of the options
+ * of the command line itself; blank lines and lines starting with '#' are skipped.
+ * The jobs are read in windows, solved in parallel, and their tables are written to stdout in the
+ * order of the job file as each window completes.
+ * \returns 0, or -1 if any job failed
+ */
+static int
+run_batch(ctl* base)
+{
+	constexpr size_t window = 64; // jobs solved between the writes of the output
+
+	std::ifstream file;
+	bool from_stdin = string(base->batch) == "-";
+	if (!from_stdin)
+	{
+		file.open(base->batch);
+		if (!file)
+		{
+			cerr << "[ERROR] batch: cannot open " << base->batch << endl;
+			return -1;
+		}
+	}
+	istream& in = from_stdin ? cin : file;
+
+	int status = 0;
+	bool summary = base->stats_summary;
+	size_t line = 0;
+	string text;
+	std::vector<job> jobs;
+	jobs.reserve(window);
+	std::unordered_set<string> files; // output files claimed by the jobs so far
+
+	while (in)
+	{
+		jobs.clear();
+
+		// The options are parsed serially, getopt is not reentrant
+		while (jobs.size() < window && getline(in, text))
+		{
+			line++;
+			istringstream tokens(text);
+			job j{.line = line, .args = {"eim"}, .ctx = *base};
+			for (string arg; tokens >> arg; )
+				j.args.push_back(arg);
+			if (j.args.size() == 1 || j.args[1][0] == '#')
+				continue;
+
+			jobs.push_back(std::move(j));
+			job& b = jobs.back();
+			std::vector<char*> argv;
+			for (auto& arg : b.args)
+				argv.push_back(arg.data());
+			argv.push_back(NULL);
+
+			b.ctx.batch = NULL;
+			if (parse(argv.size() - 1, argv.data(), &b.ctx) || validate(&b.ctx))
+				b.status = -1;
+			else if (b.ctx.batch)
+			{
+				cerr << "[ERROR] batch: jobs may not nest a job file" << endl;
+				b.status = -1;
+			}
+			else if (b.ctx.serve || b.ctx.shard_count || b.ctx.merge)
+			{
+				cerr << "[ERROR] batch: jobs write neff tables, without --serve, --shard or --merge" << endl;
+				b.status = -1;
+			}
+			else if (b.ctx.mode_log && b.ctx.mode_logname == base->mode_logname)
+			{
+				// The jobs run in parallel, and would write the same mode field file
+				cerr << "[ERROR] batch: a job with -O names its mode field file with its own -o" << endl;
+				b.status = -1;
+			}
+			else
+			{
+				// Neither may two jobs of the batch name the same file, with -o or -L
+				for (const char* name : {b.ctx.mode_log ? b.ctx.mode_logname : NULL, b.ctx.lut_logname})
+				{
+					if (name && !files.insert(name).second)
+					{
+						cerr << "[ERROR] batch: " << name << " is written by an earlier job" << endl;
+						b.status = -1;
+						break;
 					}
 				}
 			}
 
-			// TODO: 2D mode field calculation not yet implemented for slot
-			if (ctx->mode_log)
+			if (b.status)
+				cerr << "[ERROR] batch: line " << line << " skipped" << endl;
+			summary |= b.ctx.stats_summary;
+		}
+
+		auto solve = [](job& j)
+		{
+			if (j.status)
+				return;
+
+			FILE* out = open_memstream(&j.output, &j.size);
+			try
 			{
-				cerr << "[WARN]: 2D mode field calculation not implemented for slot waveguides." << endl;
+				run(&j.ctx, out);
 			}
+			catch(const exception& ex)
+			{
+				j.status = -1;
+				j.error = ex.what();
+			}
+			fclose(out);
+		};
+
+		#if PARALLEL
+			std::for_each(std::execution::par, jobs.begin(), jobs.end(), solve);
+		#else
+			std::for_each(jobs.begin(), jobs.end(), solve);
+		#endif
+
+		for (auto& j : jobs)
+		{
+			if (j.output)
+				fwrite(j.output, 1, j.size, stdout);
+			free(j.output);
+			if (!j.error.empty())
+				cerr << "[ERROR] calculation: line " << j.line << ": " << j.error << endl;
+			status |= j.status;
 		}
+		fflush(stdout);
+	}
+
+	if (summary)
+		stats::summary(stderr);
+
+	return status;
+}
+
+int main(int argc, char* argv[])
+{
+	std::unique_ptr<ctl> ctx = std::make_unique<ctl>(); //Application Control struct
+
+	if (parse(argc, argv, ctx.get()))
+		return -1;
+
+	if (ctx->batch)
+		return run_batch(ctx.get());
+
+	if (ctx->serve)
+	{
+		try
+		{
+			batcher solve;
+			if (ctx->serve_socket)
+				serve_socket(ctx->serve_socket, solve);
+			serve_stream(STDIN_FILENO, STDOUT_FILENO, solve);
+		}
+		catch(const exception& ex)
+		{
+			cerr << "[ERROR] " << ex.what() << endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	if (ctx->merge)
+	{
+		try
+		{
+			write_merge(vector<string>(argv + optind, argv + argc), stdout);
+		}
+		catch(const exception& ex)
+		{
+			cerr << "[ERROR] " << ex.what() << endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	if (validate(ctx.get()))
+		return -1;
+
+	try // Running the program
+	{
+		run(ctx.get(), stdout);
 	}
 	catch(const exception& ex)
 	{
@@ -413,5 +1491,8 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
+	if (ctx->stats_summary)
+		stats::summary(stderr);
+
 	return 0;
-}
\ No newline at end of file
+}
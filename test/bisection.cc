@@ -1,4 +1,5 @@
 #include <libopt.h>
+#include <cmath>
 #include <iostream>
 
 using namespace std;
@@ -9,12 +10,39 @@ double f(double x)
 	return 2*x - 5;
 }
 
+// Steep left of the root and flat right of it, so the first false position point lands next to 6
+double skewed(double x)
+{
+	return (x < 2.5) ? 1e3 * (x - 2.5) : 1e-3 * (x - 2.5);
+}
+
+pair<double, double> fdf(double x)
+{
+	return {f(x), 2};
+}
+
+// The root of f is 5/2, with each method held to its default tolerance
+int check(const char* name, double root, double tol, const Status& s)
+{
+	bool ok = std::fabs(root - 2.5) <= tol;
+	cout << name << " root: " << root << " iterations: " << s.iterations << (ok ? " ok" : " FAIL") << endl;
+	return ok ? 0 : 1;
+}
+
 int main(int argc, char const *argv[])
 {
+	Status s;
+	int rc = 0;
+
+	rc |= check("bisection", bisection(f, -6, 6, s), 1e-4, s);
+
+	rc |= check("brent", brent(f, -6, 6, s), 1e-10, s);
 
-	double root = bisection(f, -6, 6);
+	rc |= check("illinois", illinois(f, -6, 6, s), 1e-10, s);
 
-	cout << "root: " << root << endl;
-	
-	return 0;
-}
\ No newline at end of file
+	rc |= check("illinois skewed", illinois(skewed, -6, 6, s, 1e-4), 1e-4, s);
+
+	rc |= check("newton", newton(fdf, -6, 6, s), 1e-10, s);
+
+	return rc;
+}
@@ -0,0 +1,117 @@
+#include <ctl.h>
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+
+using namespace std;
+using namespace eim;
+
+// Checks that the lists of the command line and of files parse to the same values,
+// and that a list is sized once by its separators
+int main(int argc, char const *argv[])
+{
+	int rc = 0;
+	string list;
+	vector<double> w;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		w.push_back(0.1 + 1e-5 * i);
+		if (i)
+			list += ',';
+		list += to_string(w.back());
+	}
+
+	vector<double> a;
+	parse_numeric<double>(list.c_str(), a);
+	bool ok = a.size() == w.size() && a.capacity() == a.size();
+	for (size_t i = 0; ok && i < w.size(); i++)
+		ok = a[i] == stod(to_string(w[i]));
+	printf("parse_numeric: %zu values, capacity %zu %s\n", a.size(), a.capacity(), ok ? "ok" : "FAIL");
+	rc |= !ok;
+
+	vector<unsigned> j;
+	parse_numeric<unsigned>("0,+1,2", j);
+	ok = j == vector<unsigned>{0, 1, 2};
+	printf("orders: %zu %s\n", j.size(), ok ? "ok" : "FAIL");
+	rc |= !ok;
+
+	// A list holds only numbers: a token that is not one, or only starts as one, is an error.
+	// A number ends at a separator, so '1.5-2' is not the two numbers 1.5 and -2
+	struct { const char* list; bool real; } malformed[] = {{"0,+1,2,-3", false}, {"1.5", false}, {"2.4,cutoff", true}, {"1.5-2", true}};
+	for (auto [bad, real] : malformed)
+	{
+		try
+		{
+			vector<unsigned> orders;
+			vector<double> targets;
+			if (real)
+				parse_numeric<double>(bad, targets);
+			else
+				parse_numeric<unsigned>(bad, orders);
+			printf("malformed list %s: FAIL\n", bad);
+			rc |= 1;
+		}
+		catch(const exception& ex)
+		{
+			printf("malformed list: %s ok\n", ex.what());
+		}
+	}
+
+	vector<double> r;
+	optional<adaptive_range> adaptive;
+	parse_axis("+0.4e-6:0.6e-6:3", r, adaptive);
+	ok = r == vector<double>{0.4e-6, 0.5e-6, 0.6e-6} && !adaptive;
+	parse_axis("0.4e-6:0.6e-6:adaptive,tol=1e-5", r, adaptive);
+	ok = ok && adaptive && adaptive->tol == 1e-5 && r == vector<double>{0.4e-6, 0.6e-6};
+	printf("ranges: %s\n", ok ? "ok" : "FAIL");
+	rc |= !ok;
+
+	// Every field of a range is one number, and the number of points has no sign
+	for (const char* bad : {"400e-9:600e-9xyz:3", "lo:600e-9:3", "0.4e-6:0.6e-6:-3", "0.4e-6:0.6e-6:3x",
+							"0.4e-6:0.6e-6:adaptive,tol=1e-5x"})
+	{
+		try
+		{
+			parse_axis(bad, r, adaptive);
+			printf("malformed range %s: FAIL\n", bad);
+			rc |= 1;
+		}
+		catch(const exception& ex)
+		{
+			printf("malformed range: %s ok\n", ex.what());
+		}
+	}
+
+	auto dir = filesystem::temp_directory_path();
+	auto txt = (dir / "eim_values.txt").string(), bin = (dir / "eim_values.bin").string();
+	{
+		ofstream t(txt);
+		for (double v : a)
+			t << to_string(v) << "\n";
+		ofstream b(bin, ios::binary);
+		b.write(reinterpret_cast<const char*>(a.data()), a.size() * sizeof(double));
+	}
+
+	vector<double> t, b;
+	read_values(txt, t);
+	read_values(bin, b);
+	ok = t == a && b == a;
+	printf("read_values: txt %zu bin %zu %s\n", t.size(), b.size(), ok ? "ok" : "FAIL");
+	rc |= !ok;
+
+	ofstream(txt) << "0.3\n0.4x\n";
+	try
+	{
+		read_values(txt, t);
+		printf("malformed file: FAIL\n");
+		rc |= 1;
+	}
+	catch(const exception& ex)
+	{
+		printf("malformed file: %s ok\n", ex.what());
+	}
+
+	filesystem::remove(txt);
+	filesystem::remove(bin);
+	return rc;
+}
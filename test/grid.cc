@@ -0,0 +1,66 @@
+#include <grid.h>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+using namespace eim;
+
+int main(int argc, char const *argv[])
+{
+	const size_t pts = 4;
+	double x[pts] = {-1, -1./3, 1./3, 1};
+
+	try
+	{
+		grid_header h;
+		h.rows = h.cols = pts;
+		h.t_rib = 0.22;
+		{
+			grid_file out("grid.bin", h, 2, x, x);
+			for (size_t k = 0; k < out.size(); k++)
+			{
+				auto r = out[k];
+				r.header()->mode_order = k;
+				for (size_t i = 0; i < pts * pts; i++)
+					r.field<field_t>()[i] = field_t(k, i);
+			}
+		}
+
+		grid_view in("grid.bin");
+		for (size_t k = 0; k < in.size(); k++)
+		{
+			auto r = in[k];
+			cout << "record " << k << " mode_order: " << r.header()->mode_order 
+				<< " rows: " << r.header()->rows << " x[1]: " << r.x()[1] 
+				<< " field[5]: " << r.field<field_t>()[5] << endl;
+		}
+	}
+	catch(const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		return -1;
+	}
+
+	// A record whose size is not that of its shape is not read
+	int rc = 0;
+	for (uint64_t rows : {uint64_t(pts + 1), uint64_t(1) << 62})
+	{
+		FILE* fp = fopen("grid.bin", "r+b");
+		fseek(fp, offsetof(grid_header, rows), SEEK_SET);
+		fwrite(&rows, sizeof(rows), 1, fp);
+		fclose(fp);
+		try
+		{
+			grid_view in("grid.bin");
+			cout << "corrupt record of " << rows << " rows: FAIL" << endl;
+			rc = -1;
+		}
+		catch(const exception& ex)
+		{
+			cout << "corrupt record of " << rows << " rows: " << ex.what() << " ok" << endl;
+		}
+	}
+	remove("grid.bin");
+	return rc;
+}
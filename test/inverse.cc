@@ -0,0 +1,44 @@
+#include <strip.h>
+#include <inverse.h>
+#include <iostream>
+
+using namespace std;
+using namespace eim;
+
+// Solves the widths of target neffs and the cutoff of TE1, and checks them by forward solves
+int main(int argc, char const *argv[])
+{
+	Strip wg{1.55, 0.22, 0, 0.5, 0, 1.44, 3.47, 1.44, 0, TE};
+	vector<double> wavelengths = {1.55};
+	vector<unsigned> orders = {0, 1};
+	sweep s{wavelengths, {}, {}, orders};
+	vector<double> targets = {2.0, 2.4, cutoff};
+
+	auto neff = [&wg](const point& p) { Strip pt = wg; pt.w_rib = p.width; pt.mode_order = p.mode_order; return pt(); };
+	auto floor = [&wg](const point& p) { Strip pt = wg; pt.w_rib = p.width; return pt.cladding_index(); };
+
+	vector<double> x;
+	solve_inverse(s, WIDTH, 0.1, 2.0, targets, neff, floor, x);
+
+	int rc = 0;
+	for (size_t k = 0; k < x.size(); k++)
+	{
+		point p = s[k / targets.size()];
+		double target = targets[k % targets.size()];
+		p.width = x[k];
+		bool ok;
+		if (isnan(target))
+		{
+			// TE0 of a symmetric slab has no cutoff
+			p.width = x[k] + 1e-6;
+			ok = (p.mode_order == 0) ? isnan(x[k]) : neff(p) > floor(p);
+			p.width = x[k] - 1e-6;
+			ok = ok && (p.mode_order == 0 || neff(p) == floor(p));
+		}
+		else
+			ok = fabs(neff(p) - target) < 1e-8;
+		printf("TE%u target %g: width %.9f %s\n", p.mode_order, target, x[k], ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+	return rc;
+}
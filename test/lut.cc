@@ -0,0 +1,69 @@
+#include <lut.h>
+#include <strip.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+using namespace std;
+using namespace eim;
+
+int main(int argc, char const *argv[])
+{
+	Strip wg{1.55, 0.22, 0, 0.5, 0, 1.44, 3.47, 1.44, 0, TE};
+	auto f = [&wg](double width, double wavelength)
+	{
+		Strip pt = wg;
+		pt.w_rib = width;
+		pt.wavelength = wavelength;
+		return pt();
+	};
+
+	lut_header h;
+	h.w0 = 0.3; h.w1 = 1.0;
+	h.l0 = 1.5; h.l1 = 1.6;
+	h.tol = 1e-7;
+
+	auto t0 = chrono::steady_clock::now();
+	auto lut = neff_lut::build(f, h);
+	auto t1 = chrono::steady_clock::now();
+	lut.save("lut.bin");
+	auto in = neff_lut::load("lut.bin");
+
+	// A table whose root points past its nodes is not loaded
+	neff_lut bad = lut;
+	bad.nodes[0] = static_cast<int32_t>(bad.nodes.size());
+	bad.save("lut_bad.bin");
+	bool rejected = false;
+	try { neff_lut::load("lut_bad.bin"); }
+	catch (std::runtime_error const&) { rejected = true; }
+	std::remove("lut_bad.bin");
+	cout << "corrupt table rejected: " << (rejected ? "ok" : "FAIL") << endl;
+
+	cout << "leaves: " << in.h.leaves << " nodes: " << in.h.nodes << " error: " << in.h.error
+		<< " build: " << chrono::duration<double>(t1 - t0).count() << " s" << endl;
+
+	mt19937 gen(1);
+	uniform_real_distribution<double> W(h.w0, h.w1), L(h.l0, h.l1);
+	double worst = 0, worst_ng = 0;
+	for (int k = 0; k < 2000; k++)
+	{
+		double w = W(gen), l = L(gen), dl = 1e-5;
+		worst = max(worst, fabs(in(w, l) - f(w, l)));
+		double ng = f(w, l) - l * (f(w, l + dl) - f(w, l - dl)) / (2 * dl);
+		worst_ng = max(worst_ng, fabs(in.group_index(w, l) - ng));
+	}
+
+	vector<double> ws(1 << 16), ls(1 << 16);
+	for (size_t k = 0; k < ws.size(); k++) { ws[k] = W(gen); ls[k] = L(gen); }
+	double sum = 0;
+	t0 = chrono::steady_clock::now();
+	for (size_t k = 0; k < ws.size(); k++)
+		sum += in(ws[k], ls[k]);
+	t1 = chrono::steady_clock::now();
+
+	cout << "max error: " << worst << " max group index error: " << worst_ng
+		<< " query: " << chrono::duration<double, nano>(t1 - t0).count() / ws.size() << " ns (" << sum << ")" << endl;
+
+	return (rejected && worst <= 10 * h.tol) ? 0 : -1;
+}
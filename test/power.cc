@@ -0,0 +1,74 @@
+#include <strip.h>
+#include <slot.h>
+#include <iostream>
+#include <carray.h>
+
+using namespace std;
+using namespace eim;
+
+// Checks the closed form powers of the slab and slot profiles against the trapezoidal
+// integral of the intensity of the sampled profiles, region by region
+template<typename F>
+double
+trapz(double x0, double x1, size_t pts, F&& A)
+{
+	cvector<double> x(pts);
+	vec::linspace<double>(x.begin(), x.end(), x0, x1);
+	cvector<field_t> a(pts);
+	A(x, a);
+	double h = (x1 - x0) / (pts - 1), s = 0;
+	for (size_t i = 0; i < pts; i++)
+		s += norm(a[i]) * ((i == 0 || i + 1 == pts) ? h / 2 : h);
+	return s;
+}
+
+int main(int argc, char const *argv[])
+{
+	double n1 = 1.44, n2 = 3.47, n3 = 1.44;
+	double lam = 1.55;//um
+	double W = 0.5;//um
+	size_t pts = 20001;
+	int rc = 0;
+
+	auto slab = [&]<Mode mode>(int j, double neff)
+	{
+		auto P = slab_power<mode>(neff, n1, n2, n3, lam, W, j);
+		// The TM profile is discontinuous at the boundaries, so the ends of the tails are kept inside them
+		double edges[3][2] = {{-4, -1e-12}, {0, W}, {W + 1e-12, W + 4}};
+		for (int r = 0; r < 3; r++)
+		{
+			double p = trapz(edges[r][0], edges[r][1], pts, [&](auto& x, auto& a)
+			{
+				cvector<field_t> b(pts), n(pts);
+				mode_1D<mode>(x.begin(), x.end(), a.begin(), b.begin(), n.begin(), neff, n1, n2, n3, lam, W, j);
+			});
+			bool ok = fabs(p - P[r]) < 1e-6 * (P[0] + P[1] + P[2]);
+			printf("%s%d region %d: %g %g %s\n", mode == TE ? "TE" : "TM", j, r, P[r], p, ok ? "ok" : "FAIL");
+			rc |= !ok;
+		}
+	};
+	for (int j = 0; j < 2; j++)
+	{
+		auto neff = solve_slab(n1, n2, n3, lam, W, j);
+		slab.template operator()<TE>(j, get<0>(neff));
+		slab.template operator()<TM>(j, get<1>(neff));
+	}
+
+	double w_slot = 0.1, w_core = 0.25;
+	double a = w_slot / 2, b = a + w_core;
+	auto neff = get<0>(solve_slot_slab(n3, n2, n3, lam, w_slot, w_core, 0));
+	auto P = slot_power(neff, n3, n2, n3, lam, w_slot, w_core);
+	double edges[6] = {-b - 4, -b, -a, a, b, b + 4};
+	for (int r = 0; r < 5; r++)
+	{
+		double p = trapz(edges[r], edges[r + 1], pts, [&](auto& x, auto& A)
+		{
+			slot_mode_1D(x.begin(), x.end(), A.begin(), neff, n3, n2, n3, lam, w_slot, w_core);
+		});
+		bool ok = fabs(p - P[r]) < 1e-6 * (P[0] + P[1] + P[2] + P[3] + P[4]);
+		printf("slot region %d: %g %g %s\n", r, P[r], p, ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+
+	return rc;
+}
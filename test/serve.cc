@@ -0,0 +1,73 @@
+#include <serve.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace eim;
+
+int main(int argc, char const *argv[])
+{
+	int requests[2], responses[2];
+	if (pipe(requests) || pipe(responses))
+	{
+		cerr << "pipe failed" << endl;
+		return -1;
+	}
+
+	batcher solve;
+	thread server([&]()
+	{
+		serve_stream(requests[0], responses[1], solve);
+		close(responses[1]);
+	});
+
+	vector<request> q;
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		request r{};
+		r.id = i;
+		r.device = (i < 4) ? STRIP : SLOT;
+		r.mode = (i % 2) ? TM : TE;
+		r.wavelength = 1.55;
+		r.t_core = 0.22;
+		r.width = 0.3 + 0.1 * (i % 4);
+		r.gap = 0.1;
+		r.n_box = r.n_clad = r.n_slot = 1.44;
+		r.n_core = 3.47;
+		q.push_back(r);
+	}
+	request bad{};
+	bad.id = 8;
+	bad.device = 7;
+	q.push_back(bad);
+
+	// The requests are pipelined in writes of 50 bytes, which cut requests in half, with a pause
+	// so that the server reads each write on its own and keeps the partial request at the end of a read
+	auto bytes = reinterpret_cast<const char*>(q.data());
+	for (size_t n = q.size() * sizeof(request), k = 0; k < n; k += 50)
+	{
+		write_all(requests[1], bytes + k, min<size_t>(50, n - k));
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	close(requests[1]);
+
+	vector<response> r(q.size());
+	size_t got = 0;
+	auto buf = reinterpret_cast<char*>(r.data());
+	for (ssize_t k; got < r.size() * sizeof(response) && (k = read(responses[0], buf + got, r.size() * sizeof(response) - got)) > 0; )
+		got += k;
+	server.join();
+
+	int rc = (got == r.size() * sizeof(response)) ? 0 : -1;
+	for (size_t i = 0; i < q.size() && !rc; i++)
+	{
+		auto expected = answer(q[i]);
+		cout << "id: " << r[i].id << " status: " << int(r[i].status) << " neff: " << r[i].neff << endl;
+		if (r[i].id != q[i].id || r[i].status != expected.status || r[i].neff != expected.neff)
+			rc = -1;
+	}
+
+	cout << (rc ? "FAIL" : "PASS") << endl;
+	return rc;
+}
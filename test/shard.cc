@@ -0,0 +1,108 @@
+#include <shard.h>
+#include <sweep.h>
+#include <iostream>
+#include <filesystem>
+
+using namespace std;
+using namespace eim;
+
+// Checks that the shards of a sweep cover it exactly once, and that a merge in any order
+// restores the order of the sweep, and refuses missing shards and shards of another sweep
+int main(int argc, char const *argv[])
+{
+	int rc = 0;
+	for (size_t total : {0, 1, 7, 100, 1001})
+		for (size_t count : {1, 2, 3, 8})
+		{
+			size_t next = 0, smallest = SIZE_MAX, largest = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				auto [first, last] = shard_range(total, i, count);
+				rc |= (first != next);
+				next = last;
+				smallest = min(smallest, last - first);
+				largest = max(largest, last - first);
+			}
+			bool ok = next == total && largest - smallest <= 1;
+			if (!ok)
+				printf("total %zu count %zu: FAIL\n", total, count);
+			rc |= !ok;
+		}
+	printf("ranges: %s\n", rc ? "FAIL" : "ok");
+
+	vector<double> wavelengths{1.5, 1.55}, gaps{0.1, 0.12}, widths{0.2, 0.25, 0.3};
+	vector<unsigned> orders{0, 1};
+	sweep s{wavelengths, gaps, widths, orders};
+	const size_t count = 3;
+
+	auto dir = filesystem::temp_directory_path();
+	vector<string> paths;
+	for (size_t i = count; i-- > 0;) // written in reverse, to be put back in order
+	{
+		auto [first, last] = shard_range(s.size(), i, count);
+		shard_file f;
+		f.h.device = SLOT;
+		f.h.index = i;
+		f.h.count = count;
+		f.h.total = s.size();
+		f.h.first = first;
+		f.h.points = last - first;
+		f.h.digest = sweep_digest(s);
+		for (size_t k = first; k < last; k++)
+		{
+			auto p = s[k];
+			f.records.push_back({p.wavelength, p.gap, p.width, double(k), p.mode_order});
+		}
+		paths.push_back((dir / ("eim_shard_" + to_string(i) + ".tmp")).string());
+		FILE* fp = fopen(paths.back().c_str(), "wb");
+		f.save(fp);
+		fclose(fp);
+	}
+
+	shard_header h;
+	auto records = merge_shards(paths, h);
+	bool ok = records.size() == s.size() && h.total == s.size();
+	for (size_t k = 0; ok && k < records.size(); k++)
+		ok = records[k].neff == double(k) && records[k].width == s[k].width && records[k].mode_order == s[k].mode_order;
+	printf("merge: %zu points %s\n", records.size(), ok ? "ok" : "FAIL");
+	rc |= !ok;
+
+	bool refused = false;
+	try
+	{
+		merge_shards({paths[0], paths[2]}, h);
+	}
+	catch (const runtime_error& e)
+	{
+		refused = true;
+		printf("missing shard: %s ok\n", e.what());
+	}
+	rc |= !refused;
+
+	// A shard of other widths, with the same stack and number of points
+	vector<double> others{0.2, 0.25, 0.35};
+	sweep t{wavelengths, gaps, others, orders};
+	{
+		shard_file f = shard_file::load(paths[0]);
+		f.h.digest = sweep_digest(t);
+		FILE* fp = fopen(paths[0].c_str(), "wb");
+		f.save(fp);
+		fclose(fp);
+	}
+	refused = false;
+	try
+	{
+		merge_shards(paths, h);
+	}
+	catch (const runtime_error& e)
+	{
+		refused = true;
+		printf("other sweep: %s ok\n", e.what());
+	}
+	rc |= !refused;
+
+	for (const auto& path : paths)
+		filesystem::remove(path);
+
+	return rc;
+}
@@ -0,0 +1,80 @@
+#include <slot.h>
+#include <batch.h>
+#include <iostream>
+#include <carray.h>
+
+using namespace std;
+using namespace eim;
+
+// Checks the slot mode profile against the boundary conditions of the slot equation:
+// the field and (1/n^2) dA/dx are continuous at |x| = a and |x| = b
+int main(int argc, char const *argv[])
+{
+	double n_clad = 1.44, n_core = 3.47, n_slot = 1.44;
+	double lam = 1.55;//um
+	double w_slot = 0.1, w_core = 0.25;
+	double a = w_slot / 2, b = a + w_core;
+	double h = 1e-7;
+
+	auto neff = get<0>(solve_slot_slab(n_clad, n_core, n_slot, lam, w_slot, w_core, 0));
+	printf("neff:%g\n", neff);
+
+	// Two points either side of every boundary, and a uniform grid for the fast path
+	// The boundaries, with the indices of their left and right regions
+	double edges[4][3] = {{-b, n_clad, n_core}, {-a, n_core, n_slot}, {a, n_slot, n_core}, {b, n_core, n_clad}};
+	int rc = 0;
+	for (auto [e, n_l, n_r] : edges)
+	{
+		cvector<double> x(4);
+		x[0] = e - 2 * h; x[1] = e - h; x[2] = e + h; x[3] = e + 2 * h;
+		cvector<field_t> A(4);
+		slot_mode_1D(x.begin(), x.end(), A.begin(), neff, n_clad, n_core, n_slot, lam, w_slot, w_core);
+
+		double dl = (A[1].real() - A[0].real()) / h / (n_l * n_l);
+		double dr = (A[3].real() - A[2].real()) / h / (n_r * n_r);
+		double jump = fabs(A[1].real() - A[2].real());
+		bool ok = jump < 1e-5 && fabs(dl - dr) < 1e-3 * (fabs(dl) + fabs(dr) + 1);
+		printf("x=%+.3f A=%g jump=%.2e dA/n2 %g %g %s\n", e, A[1].real(), jump, dl, dr, ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+
+	// The blocked progression of a uniform grid agrees with the pointwise evaluation
+	size_t pts = 4001;
+	cvector<double> x(pts);
+	vec::linspace<double>(x.begin(), x.end(), -1, 1);
+	cvector<field_t> A(pts), B(pts);
+	slot_mode_1D(x.begin(), x.end(), A.begin(), neff, n_clad, n_core, n_slot, lam, w_slot, w_core);
+	x[pts - 1] = 1 + 1e-3; // no longer uniform
+	slot_mode_1D(x.begin(), x.end(), B.begin(), neff, n_clad, n_core, n_slot, lam, w_slot, w_core);
+	double err = 0;
+	for (size_t i = 0; i + 1 < pts; i++)
+		err = max(err, abs(A[i] - B[i]));
+	printf("uniform vs pointwise: %.2e %s\n", err, err < 1e-9 ? "ok" : "FAIL");
+	rc |= !(err < 1e-9);
+
+	// The lanes of the batch agree with the serial solves, for both parities
+	// n_slot = n_clad has the odd mode cut off where the slot field flattens
+	vector<double> ncl, nc, ns, ws, wc, l;
+	vector<int> j;
+	vector<uint8_t> odd;
+	for (double n : {1.0, 1.44})
+		for (double w = 0.05; w < 0.8; w += 0.01)
+			for (int o : {0, 1})
+			{
+				ncl.push_back(1.44); nc.push_back(n_core); ns.push_back(n);
+				ws.push_back(w_slot); wc.push_back(w); l.push_back(lam); j.push_back(0); odd.push_back(o);
+			}
+	slot_batch sb{ncl.data(), nc.data(), ns.data(), l.data(), ws.data(), wc.data(), j.data(), odd.data(), ncl.size()};
+	vector<double> lanes(sb.size);
+	solve_slot_batch(sb, lanes.data());
+	err = 0;
+	for (size_t i = 0; i < sb.size; i++)
+	{
+		auto n = solve_slot_slab(ncl[i], nc[i], ns[i], l[i], ws[i], wc[i], j[i], nullopt, BOTH_MODES);
+		err = max(err, fabs((odd[i] ? get<1>(n) : get<0>(n)) - lanes[i]));
+	}
+	printf("lanes vs serial: %.2e %s\n", err, err < 1e-9 ? "ok" : "FAIL");
+	rc |= !(err < 1e-9);
+
+	return rc;
+}
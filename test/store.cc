@@ -0,0 +1,65 @@
+#include <store.h>
+#include <iostream>
+#include <filesystem>
+#include <numeric>
+#include <algorithm>
+
+using namespace std;
+using namespace eim;
+
+// Checks that the persistent store answers what was inserted, across a reopen that grows it,
+// and under parallel inserts and lookups
+int main(int argc, char const *argv[])
+{
+	auto path = (filesystem::temp_directory_path() / "eim_store.tmp").string();
+	filesystem::remove(path);
+	int rc = 0;
+
+	auto key = [](size_t i)
+	{
+		return store_key{.device = SLOT, .mode = TE, .mode_order = unsigned(i % 3),
+			.wavelength = 1.5 + 1e-3 * (i / 3), .width = 0.3, .gap = 0.1, .t_core = 0.22, .t_slab = 0,
+			.n_box = 1.44, .n_core = 3.47, .n_clad = 1.44, .n_slot = 1.44};
+	};
+
+	const size_t N = 5000;
+	{
+		neff_store store(path, 100);
+		for (size_t i = 0; i < 100; i++)
+			store.insert(key(i), double(i));
+		bool ok = store.count() == 100 && !store.insert(key(7), -1) && store.find(key(7)) == 7.0 && !store.find(key(100));
+		printf("insert: %zu points %s\n", store.count(), ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+
+	{
+		// Reopened with room for N points, the store is rehashed into a larger table
+		neff_store store(path, N);
+		vector<size_t> idx(N);
+		iota(idx.begin(), idx.end(), 0);
+		auto solve = [&](size_t i) { if (!store.find(key(i))) store.insert(key(i), double(i)); };
+		#if PARALLEL
+			for_each(execution::par, idx.begin(), idx.end(), solve);
+		#else
+			for_each(idx.begin(), idx.end(), solve);
+		#endif
+		bool ok = store.count() == N;
+		for (size_t i = 0; ok && i < N; i++)
+			ok = store.find(key(i)) == double(i);
+		printf("grow and parallel insert: %zu points %s\n", store.count(), ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+
+	{
+		// Another solver version is another key
+		neff_store store(path);
+		store_key k = key(1);
+		k.version++;
+		bool ok = store.count() == N && !store.find(k) && store.find(key(1)) == 1.0;
+		printf("reopen: %s\n", ok ? "ok" : "FAIL");
+		rc |= !ok;
+	}
+
+	filesystem::remove(path);
+	return rc;
+}